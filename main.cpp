@@ -61,6 +61,23 @@ int main()
             std::getline(std::cin, fen);
             if (fen.empty()) break;
 
+            // Network can be replaced at any time with "setoption name EvalFile value <path>"
+            // - It is loaded in the background and swapped in before the next search
+            const std::string eval_file_option = "setoption name EvalFile value ";
+            if (fen.starts_with(eval_file_option)) {
+                engine->load_network(fen.substr(eval_file_option.size()));
+                continue;
+            }
+
+            try {
+                if (engine->update_network(true))
+                    std::cout << "- Network " << engine->network().filepath << " loaded in " << 
+                                 engine->network().load_time.count() / 1000.0 << " [ms]\n";
+            }
+            catch (const std::exception& e) {
+                std::cout << e.what() << "\n";
+            }
+
             int depth;
             std::cout << ">>> ";
             std::cin >> depth;
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cstring>
 #include <sstream>
+#include <stdexcept>
 
 
 namespace Chessboard {
@@ -21,6 +22,7 @@ namespace Chessboard {
 
         // Shrink position stack to ply 0 only and reset the data
         m_pstack.shrink();
+        m_xstack.shrink();
         m_pstack.top() = Position();    // Default constructor for Position creates an empty board data
     }
 
@@ -58,7 +60,7 @@ namespace Chessboard {
 
                 place_piece(make_piece(color, type), square);
 
-                m_pstack.top().game_stage += Evaluation::GameStage::PieceWeights[type];
+                m_pstack.top().material_key += Evaluation::material_key(make_piece(color, type));
 
                 file++;
             }
@@ -95,12 +97,11 @@ namespace Chessboard {
 
         // Checks & pins update
         update_checks();
-        update_pins(WHITE);
-        update_pins(BLACK);
 
         // Zobrist hash update (static)
         m_zobrist.generate(*this);
         m_pstack.top().hash = m_zobrist.hash();
+        m_pstack.top().pawn_hash = Zobrist::generate_pawn_hash(*this);
     }
 
     void Board::load_position(const Board& other)
@@ -114,8 +115,11 @@ namespace Chessboard {
 	    std::copy(other.m_kings, other.m_kings + COLOR_RANGE, m_kings);
 
         // Reset the stack and simply copy position data from other
+        // - Lazy extras are not copied, they will be recalculated on demand
         m_pstack.shrink();
+        m_xstack.shrink();
         m_pstack.top() = other.m_pstack.top();
+        m_pstack.top().extras_ready = 0;
 
         // Clear fields related to last move (since we do not keep track of previous positions from other board)
         m_pstack.top().last_move = Moves::null;
@@ -126,35 +130,207 @@ namespace Chessboard {
     }
 
 
+    void Board::load_position(const BoardState& state)
+    {
+        // Copy common data
+        m_moving_side = Color(state.side_to_move);
+        m_halfmoves = state.halfmoves;
+        for (uint32_t sq = 0; sq < SQUARE_RANGE; sq++)
+            m_board[sq] = Piece(state.board[sq]);
+        std::copy(state.pieces_c, state.pieces_c + COLOR_RANGE, m_pieces_c);
+        std::copy(state.pieces_t, state.pieces_t + PIECE_TYPE_RANGE, m_pieces_t);
+        m_kings[WHITE] = Square(state.kings[WHITE]);
+        m_kings[BLACK] = Square(state.kings[BLACK]);
+
+        // Reset the stack and fill position data from state
+        // - State has no history, so irreversible distance starts from 0 (repetitions cannot be detected before this position)
+        m_pstack.shrink();
+        m_xstack.shrink();
+        m_pstack.top() = Position();
+        m_pstack.top().castling_rights = state.castling_rights;
+        m_pstack.top().enpassant_square = state.enpassant_square;
+        m_pstack.top().halfmove_clock = state.halfmove_clock;
+        m_pstack.top().material_key = state.material_key;
+        m_pstack.top().hash = state.hash;
+        m_pstack.top().pawn_hash = state.pawn_hash;
+
+        // Load zobrist hash
+        m_zobrist.set(state.hash);
+
+        // Checks & pins update
+        update_checks();
+    }
+
+    BoardState Board::state() const
+    {
+        BoardState state;
+
+        for (uint32_t sq = 0; sq < SQUARE_RANGE; sq++)
+            state.board[sq] = uint8_t(m_board[sq]);
+        std::copy(m_pieces_t, m_pieces_t + PIECE_TYPE_RANGE, state.pieces_t);
+        std::copy(m_pieces_c, m_pieces_c + COLOR_RANGE, state.pieces_c);
+
+        state.hash = m_pstack.top().hash;
+        state.pawn_hash = m_pstack.top().pawn_hash;
+        state.material_key = m_pstack.top().material_key;
+
+        state.halfmoves = m_halfmoves;
+        state.halfmove_clock = m_pstack.top().halfmove_clock;
+
+        state.kings[WHITE] = uint8_t(m_kings[WHITE]);
+        state.kings[BLACK] = uint8_t(m_kings[BLACK]);
+        state.side_to_move = uint8_t(m_moving_side);
+        state.castling_rights = m_pstack.top().castling_rights;
+        state.enpassant_square = m_pstack.top().enpassant_square;
+
+        return state;
+    }
+
+
+    void Board::load_position(const PackedPosition& packed)
+    {
+        uint64_t codes[2];
+        std::memcpy(codes, packed.pieces, sizeof(codes));
+
+        // Part 0 - validation
+        // - Encoding may come from an external source, so it's validated before the board is touched
+        // - Every occupied square must hold an actual piece, and each side must have exactly one king
+        unsigned count = Bitboards::popcount(packed.occupancy);
+        unsigned kings[COLOR_RANGE] = { 0, 0 };
+
+        if (count > 32)
+            throw std::invalid_argument("ERROR: Packed position has more than 32 pieces");
+
+        for (unsigned i = 0; i < count; i++) {
+            Piece piece = Piece((codes[i / 16] >> (4 * (i % 16))) & 0xF);
+
+            if (type_of(piece) == NULL_PIECE_TYPE || type_of(piece) > KING)
+                throw std::invalid_argument("ERROR: Packed position contains invalid piece code " + std::to_string(piece));
+            if (type_of(piece) == KING)
+                kings[color_of(piece)]++;
+        }
+
+        if (kings[WHITE] != 1 || kings[BLACK] != 1)
+            throw std::invalid_argument("ERROR: Packed position must contain exactly one king of each side");
+        if ((packed.flags >> 4) > BLACK || packed.enpassant_square > NULL_SQUARE)
+            throw std::invalid_argument("ERROR: Packed position has invalid side to move or enpassant square");
+
+        clear();
+
+        // Part 1 - piece placement
+        // - Hashes and material data are accumulated along with piece placement, which is much faster than generating
+        //   them from scratch afterwards
+
+        Evaluation::MaterialKey material_key = 0;
+        Zobrist::Hash hash = 0, pawn_hash = 0;
+
+        Bitboard occupancy = packed.occupancy;
+        for (unsigned i = 0; occupancy; i++) {
+            Square sq = Bitboards::pop_lsb(occupancy);
+            Piece piece = Piece((codes[i / 16] >> (4 * (i % 16))) & 0xF);
+
+            place_piece(piece, sq);
+
+            material_key += Evaluation::material_key(piece);
+            hash ^= Zobrist::piece_hash(piece, sq);
+            if (type_of(piece) == PAWN)
+                pawn_hash ^= Zobrist::piece_hash(piece, sq);
+        }
+
+        m_pstack.top().material_key = material_key;
+        m_pstack.top().pawn_hash = pawn_hash;
+        m_zobrist.set(hash);
+
+        // Part 2 - other aspects of the position
+        m_moving_side = Color(packed.flags >> 4);
+        m_pstack.top().castling_rights = packed.flags & 0xF;
+        m_pstack.top().enpassant_square = Square(packed.enpassant_square);
+        m_pstack.top().halfmove_clock = packed.halfmove_clock;
+        m_halfmoves = packed.halfmoves;
+
+        if (m_moving_side == BLACK)
+            m_zobrist.update(BLACK);
+        m_zobrist.update(m_pstack.top().castling_rights);
+        m_zobrist.update(m_pstack.top().enpassant_square);
+        m_pstack.top().hash = m_zobrist.hash();
+
+        // Checks & pins update
+        update_checks();
+    }
+
+    PackedPosition Board::encode() const
+    {
+        PackedPosition packed;
+
+        // Piece codes are accumulated in registers and stored at once
+        // - Only legal positions fit into the encoding, so positions with more than 32 pieces (possible through FEN) are rejected
+        uint64_t codes[2] = { 0, 0 };
+
+        packed.occupancy = pieces();
+
+        if (Bitboards::popcount(packed.occupancy) > 32)
+            throw std::invalid_argument("ERROR: Position with more than 32 pieces cannot be packed");
+
+        Bitboard occupancy = packed.occupancy;
+        for (unsigned i = 0; occupancy; i++)
+            codes[i / 16] |= uint64_t(m_board[Bitboards::pop_lsb(occupancy)]) << (4 * (i % 16));
+
+        std::memcpy(packed.pieces, codes, sizeof(codes));
+
+        packed.halfmoves = m_halfmoves;
+        packed.halfmove_clock = uint8_t(m_pstack.top().halfmove_clock);
+        packed.flags = uint8_t(m_moving_side << 4 | m_pstack.top().castling_rights);
+        packed.enpassant_square = uint8_t(m_pstack.top().enpassant_square);
+
+        return packed;
+    }
+
+
     // ---------------------------------------------------------------------
     // Board - position change - dynamic (move make & unmake) - normal moves
     // ---------------------------------------------------------------------
 
+    // Move maker targets - board itself
+    // - Previous ply is already pushed down the position stack, while the next one is on top of it
+    struct Board::StackTarget
+    {
+        Board& board;
+        const Position& prev;
+        Position& next;
+
+        StackTarget(Board& board) : board(board), prev(board.m_pstack.top_n(1)), next(board.m_pstack.top()) {}
+
+        // Position analysis
+        Piece on(Square sq) const { return board.m_board[sq]; }
+        Bitboard pieces(Color side, PieceType ptype) const { return board.pieces(side, ptype); }
+        Color side() const { return board.m_moving_side; }
+
+        // Piece placement & hash updates
+        void place_piece(Piece piece, Square sq) { board.place_piece(piece, sq); }
+        void remove_piece(Square sq) { board.remove_piece(sq); }
+        void move_piece(Square from, Square to) { board.move_piece(from, to); }
+        template <typename... Args>
+        void update_hash(Args... args) { board.m_zobrist.update(args...); }
+
+        // Data required only to unmake moves and to detect repetitions
+        void set_captured(Piece piece) { next.captured = piece; }
+        void set_irreversible(bool irreversible) { next.irr_distance = irreversible ? 0 : prev.irr_distance + 1; }
+    };
+
     // Main move maker function
     void Board::make_move(const Move& move)
     {
         // Push position stack to make room for new ply data
+        // - Stack memory is reused, so lazy data flags must be reset
         m_pstack.push();
+        m_xstack.push();
 
         m_pstack.top().last_move = move;
+        m_pstack.top().extras_ready = 0;
 
-        // Delegate further updates to specialized function for each move type
-        switch (move.type()) {
-            case Moves::NORMAL:
-                make_normal(move);
-                break;
-            case Moves::PROMOTION:
-                make_promotion(move);
-                break;
-            case Moves::ENPASSANT:
-                make_enpassant(move);
-                break;
-            case Moves::CASTLE:
-                make_castle(move);
-                break;
-            default:
-                return;
-        }
+        // Delegate updates of piece placement and position data to shared move makers
+        StackTarget target(*this);
+        make_pieces(target, move);
 
         // Side to move change
         m_moving_side = ~m_moving_side;
@@ -163,8 +339,6 @@ namespace Chessboard {
         // Check & pin update - common for all types of moves
         // - NOTE: It's important to update side to move before update_checks() call
         update_checks();
-	    update_pins(WHITE);
-	    update_pins(BLACK);
 
         // Halfmove counter update - common for all types of moves
         m_halfmoves++;
@@ -174,168 +348,220 @@ namespace Chessboard {
 
     }
 
+    // Shared move makers - dispatch
+    template <typename Target>
+    void Board::make_pieces(Target& target, const Move& move)
+    {
+        target.next.pawn_hash = target.prev.pawn_hash;
+        target.next.material_key = target.prev.material_key;
+
+        // Delegate further updates to specialized function for each move type
+        switch (move.type()) {
+            case Moves::NORMAL:
+                make_normal(target, move);
+                break;
+            case Moves::PROMOTION:
+                make_promotion(target, move);
+                break;
+            case Moves::ENPASSANT:
+                make_enpassant(target, move);
+                break;
+            case Moves::CASTLE:
+                make_castle(target, move);
+                break;
+            default:
+                return;
+        }
+    }
+
     // Specialized move makers - normal moves
-    void Board::make_normal(const Move& move)
+    template <typename Target>
+    void Board::make_normal(Target& target, const Move& move)
     {
+        const auto& prev = target.prev;
+        auto& next = target.next;
+
         Square from = move.from();
         Square to = move.to();
-        Piece piece = m_board[from];
+        Piece piece = target.on(from);
 
         // Step 1 - update piece placement & related properties
         // - Normal move can be either quiet or capture
         if (move.is_capture()) {
-            m_pstack.top().captured = m_board[to];
-            m_pstack.top().game_stage = m_pstack.top_n(1).game_stage - 
-                                        Evaluation::GameStage::PieceWeights[type_of(m_pstack.top().captured)];
+            Piece captured = target.on(to);
 
-            m_zobrist.update(m_board[to], to);
-            remove_piece(to);
+            target.set_captured(captured);
+            next.material_key -= Evaluation::material_key(captured);
+
+            if (type_of(captured) == PAWN)
+                next.pawn_hash ^= Zobrist::piece_hash(captured, to);
+
+            target.update_hash(captured, to);
+            target.remove_piece(to);
         }
-        else 
-            m_pstack.top().game_stage = m_pstack.top_n(1).game_stage;   // No capture = no change in game stage
 
-        m_zobrist.update(piece, from);
-        m_zobrist.update(piece, to);
-        move_piece(from, to);
+        if (type_of(piece) == PAWN)
+            next.pawn_hash ^= Zobrist::piece_hash(piece, from) ^ Zobrist::piece_hash(piece, to);
+
+        target.update_hash(piece, from);
+        target.update_hash(piece, to);
+        target.move_piece(from, to);
 
         // Step 2 - update castling rights
         // - For more exaplanation, see CastleLoss table comments
-        m_zobrist.update(m_pstack.top_n(1).castling_rights);
-        m_pstack.top().castling_rights = m_pstack.top_n(1).castling_rights & ~CastleLoss[from] & ~CastleLoss[to];
-        m_zobrist.update(m_pstack.top().castling_rights);
+        target.update_hash(prev.castling_rights);
+        next.castling_rights = prev.castling_rights & ~CastleLoss[from] & ~CastleLoss[to];
+        target.update_hash(next.castling_rights);
 
         // Step 3 - update enpassant square
         // - Every normal move resets enpassant square except double pawn pushes
-        m_zobrist.update(m_pstack.top_n(1).enpassant_square);
-        m_pstack.top().enpassant_square = move.is_double_pawn_push() && adjacent_rank_squares(to) & pieces(~m_moving_side, PAWN) ? to : NULL_SQUARE;
-        m_zobrist.update(m_pstack.top().enpassant_square);
+        target.update_hash(prev.enpassant_square);
+        next.enpassant_square = move.is_double_pawn_push() && (adjacent_rank_squares(to) & target.pieces(~target.side(), PAWN)) ? to : NULL_SQUARE;
+        target.update_hash(next.enpassant_square);
 
         // Step 4 - other updates
-        m_pstack.top().halfmove_clock = move.is_capture() || type_of(piece) == PAWN ? 0 : m_pstack.top_n(1).halfmove_clock + 1;
-        m_pstack.top().irr_distance = move.is_capture() || type_of(piece) == PAWN ? 0 : m_pstack.top_n(1).irr_distance + 1;
+        next.halfmove_clock = move.is_capture() || type_of(piece) == PAWN ? 0 : prev.halfmove_clock + 1;
+        target.set_irreversible(move.is_capture() || type_of(piece) == PAWN);
     }
 
     // Specialized move makers - promotions
-    void Board::make_promotion(const Move& move)
+    template <typename Target>
+    void Board::make_promotion(Target& target, const Move& move)
     {
+        const auto& prev = target.prev;
+        auto& next = target.next;
+
         // We know that moving piece is a pawn
         Square from = move.from();
         Square to = move.to();
-        Piece promoted = make_piece(m_moving_side, move.promotion_type());
+        Piece pawn = target.on(from);
+        Piece promoted = make_piece(target.side(), move.promotion_type());
 
         // Step 1 - update piece placement & related properties
         // - Promotions, similarly to normal moves, can rither capture something or not
         // - We handle promotions with remove_piece + place_piece instead of move_piece to change piece type
-
-        // Update piece value sum (promotion brings new piece to the board)
-        m_pstack.top().game_stage = m_pstack.top_n(1).game_stage + Evaluation::GameStage::PieceWeights[move.promotion_type()];
-
         if (move.is_capture()) {
-            m_pstack.top().captured = m_board[to];
-            m_pstack.top().game_stage -= Evaluation::GameStage::PieceWeights[type_of(m_pstack.top().captured)];
+            Piece captured = target.on(to);
 
-            m_zobrist.update(m_board[to], to);
-            remove_piece(to);
+            target.set_captured(captured);
+            next.material_key -= Evaluation::material_key(captured);
+
+            target.update_hash(captured, to);
+            target.remove_piece(to);
         }
         
-        m_zobrist.update(m_board[from], from);
-        remove_piece(from);
-        m_zobrist.update(promoted, to);
-        place_piece(promoted, to);
+        next.pawn_hash ^= Zobrist::piece_hash(pawn, from);
+        next.material_key += Evaluation::material_key(promoted) - Evaluation::material_key(pawn);
+
+        target.update_hash(pawn, from);
+        target.remove_piece(from);
+        target.update_hash(promoted, to);
+        target.place_piece(promoted, to);
 
         // Step 2 - update castling rights
         // - Promotion cannot affect castling rights unless it comes with a capture of enemy rook
-        m_pstack.top().castling_rights = m_pstack.top_n(1).castling_rights;
+        next.castling_rights = prev.castling_rights;
         if (move.is_capture()) {
-            m_zobrist.update(m_pstack.top_n(1).castling_rights);
-            m_pstack.top().castling_rights &= ~CastleLoss[to];
-            m_zobrist.update(m_pstack.top().castling_rights);
+            target.update_hash(prev.castling_rights);
+            next.castling_rights &= ~CastleLoss[to];
+            target.update_hash(next.castling_rights);
         }
 
         // Step 3 - update enpassant square
         // - Promotion always reset enpassant square
-        m_zobrist.update(m_pstack.top_n(1).enpassant_square);
-        m_pstack.top().enpassant_square = NULL_SQUARE;
-        m_zobrist.update(NULL_SQUARE);
+        target.update_hash(prev.enpassant_square);
+        next.enpassant_square = NULL_SQUARE;
+        target.update_hash(NULL_SQUARE);
 
         // Step 4 - other updates
-        m_pstack.top().halfmove_clock = 0;
-        m_pstack.top().irr_distance = 0;
+        next.halfmove_clock = 0;
+        target.set_irreversible(true);
     }
 
     // Specialized move makers - enpassant
-    void Board::make_enpassant(const Move& move)
+    template <typename Target>
+    void Board::make_enpassant(Target& target, const Move& move)
     {
+        const auto& prev = target.prev;
+        auto& next = target.next;
+
         // We know that moving piece is a pawn
         Square from = move.from();
         Square to = move.to();
-        Square capture_square = m_pstack.top_n(1).enpassant_square;
+        Square capture_square = prev.enpassant_square;
+        Piece pawn = target.on(from);
+        Piece captured = target.on(capture_square);
 
         // Step 1 - update piece placement & related properties
         // - Enpassant is by definition always a capture
         // - Unlike the normal captures, enpassant captures the pawn outside the target (to) square - on enpassant square
 
-        m_pstack.top().captured = m_board[capture_square];
-        m_pstack.top().game_stage = m_pstack.top_n(1).game_stage;
+        target.set_captured(captured);
+        next.material_key -= Evaluation::material_key(captured);
+        next.pawn_hash ^= Zobrist::piece_hash(captured, capture_square) ^ Zobrist::piece_hash(pawn, from) ^ Zobrist::piece_hash(pawn, to);
 
-        m_zobrist.update(m_board[capture_square], capture_square);
-        remove_piece(capture_square);
-        m_zobrist.update(m_board[from], from);
-        m_zobrist.update(m_board[from], to);
-        move_piece(from, to);
+        target.update_hash(captured, capture_square);
+        target.remove_piece(capture_square);
+        target.update_hash(pawn, from);
+        target.update_hash(pawn, to);
+        target.move_piece(from, to);
 
         // Step 2 - update castling rights
         // - Enpassant cannot affect castling rights in any way
-        m_pstack.top().castling_rights = m_pstack.top_n(1).castling_rights;
+        next.castling_rights = prev.castling_rights;
 
         // Step 3 - update enpassant square
         // - Enpassant always resets enpassant square
-        m_zobrist.update(capture_square);   // capture_square is simultanously an enpassant square from previous ply
-        m_pstack.top().enpassant_square = NULL_SQUARE;
-        m_zobrist.update(NULL_SQUARE);
+        target.update_hash(capture_square);   // capture_square is simultanously an enpassant square from previous ply
+        next.enpassant_square = NULL_SQUARE;
+        target.update_hash(NULL_SQUARE);
 
         // Step 4 - other updates
-        m_pstack.top().halfmove_clock = 0;
-        m_pstack.top().irr_distance = 0;
+        next.halfmove_clock = 0;
+        target.set_irreversible(true);
     }
 
     // Specialized move makers - castle
-    void Board::make_castle(const Move& move)
+    template <typename Target>
+    void Board::make_castle(Target& target, const Move& move)
     {
+        const auto& prev = target.prev;
+        auto& next = target.next;
+
         // Move contains starting and target square for king shift
         Square king_from = move.from();
         Square king_to = move.to();
         Square rook_from = make_square(rank_of(king_to), file_of(king_to) == ::FILE_G ? ::FILE_H : ::FILE_A);
         Square rook_to = make_square(rank_of(king_to), file_of(king_to) == ::FILE_G ? ::FILE_F : ::FILE_D);
+        Piece king = target.on(king_from);
+        Piece rook = target.on(rook_from);
 
         // Step 1 - update piece placement & related properties
         // - Castle consists of two independent moves: king move by 2 squares, and appropriate rook move
-        m_pstack.top().game_stage = m_pstack.top_n(1).game_stage;
-
-        m_zobrist.update(m_board[king_from], king_from);
-        m_zobrist.update(m_board[king_from], king_to);
-        move_piece(king_from, king_to);
-        m_zobrist.update(m_board[rook_from], rook_from);
-        m_zobrist.update(m_board[rook_from], rook_to);
-        move_piece(rook_from, rook_to);
+        target.update_hash(king, king_from);
+        target.update_hash(king, king_to);
+        target.move_piece(king_from, king_to);
+        target.update_hash(rook, rook_from);
+        target.update_hash(rook, rook_to);
+        target.move_piece(rook_from, rook_to);
 
         // Step 2 - update castling rights
         // - Castling discards all the castling rights for castling side
         // - Equivalent to masking by castle loss for king move
-        m_zobrist.update(m_pstack.top_n(1).castling_rights);
-        m_pstack.top().castling_rights = m_pstack.top_n(1).castling_rights & ~CastleLoss[king_from];
-        m_zobrist.update(m_pstack.top().castling_rights);
+        target.update_hash(prev.castling_rights);
+        next.castling_rights = prev.castling_rights & ~CastleLoss[king_from];
+        target.update_hash(next.castling_rights);
 
         // Step 3 - update enpassant square
         // - Castling always resets enpassant square
-        m_zobrist.update(m_pstack.top_n(1).enpassant_square);
-        m_pstack.top().enpassant_square = NULL_SQUARE;
-        m_zobrist.update(NULL_SQUARE);
+        target.update_hash(prev.enpassant_square);
+        next.enpassant_square = NULL_SQUARE;
+        target.update_hash(NULL_SQUARE);
 
         // Step 4 - other updates
         // - Castling is considered irreversible move, but it does not reset halfmove clock
-        m_pstack.top().halfmove_clock = m_pstack.top_n(1).halfmove_clock + 1;
-        m_pstack.top().irr_distance = 0;
+        next.halfmove_clock = prev.halfmove_clock + 1;
+        target.set_irreversible(true);
     }
 
     // Unmaking moves
@@ -384,6 +610,7 @@ namespace Chessboard {
 
         // Step 3 - revert all the other changes by decrementing position stack
         m_pstack.pop();
+        m_xstack.pop();
 
         // Step 4 - restore zobrist hash
         m_zobrist.set(m_pstack.top().hash);
@@ -399,12 +626,13 @@ namespace Chessboard {
     {
         // Push position stack to make room for new ply data
         m_pstack.push();
+        m_xstack.push();
 
         // Null move is a passing move with the following properties:
         // - Null move changes side to move
         // - Null move does not affect piece placement and castling rights
         // - Null move might reset enpassant square if it's not a NULL_SQUARE yet
-        // - Null move requires update_checks() to be called, since this method is relative to current side to move
+        // - Null move requires update_checks() to be called, since checks & pins are relative to current side to move
 
         // Change side to move
         m_moving_side = ~m_moving_side;
@@ -415,6 +643,7 @@ namespace Chessboard {
 
         m_pstack.top().last_move = Moves::null;
         m_pstack.top().captured = NO_PIECE;
+        m_pstack.top().extras_ready = 0;
 
         m_zobrist.update(m_pstack.top_n(1).enpassant_square);
         m_pstack.top().enpassant_square = NULL_SQUARE;
@@ -422,7 +651,7 @@ namespace Chessboard {
 
         m_pstack.top().hash = m_zobrist.hash();
 
-        // Calculate checks for new side to move
+        // Calculate checks & pins for new side to move
         update_checks();
 
         // NOTE: since null move is not really a legal move, we do not increase halfmoves counter
@@ -434,6 +663,7 @@ namespace Chessboard {
         // Since null move does not affect piece placement, reverting it is very simple
         m_moving_side = ~m_moving_side;
         m_pstack.pop();
+        m_xstack.pop();
         m_zobrist.set(m_pstack.top().hash);
     }
 
@@ -444,12 +674,12 @@ namespace Chessboard {
 
     Bitboard Board::attackers_to(Square sq, Bitboard occ) const
     {
-        return Pieces::pawn_attacks(WHITE, sq) & pieces(BLACK, PAWN) | 
-		       Pieces::pawn_attacks(BLACK, sq) & pieces(WHITE, PAWN) |
-		       Pieces::piece_attacks_s<KNIGHT>(sq) & pieces(KNIGHT) |
-		       Pieces::piece_attacks_s<BISHOP>(sq, occ) & pieces(BISHOP, QUEEN) |
-		       Pieces::piece_attacks_s<ROOK>(sq, occ) & pieces(ROOK, QUEEN) |
-		       Pieces::piece_attacks_s<KING>(sq) & pieces(KING);
+        return (Pieces::pawn_attacks(WHITE, sq) & pieces(BLACK, PAWN)) | 
+		       (Pieces::pawn_attacks(BLACK, sq) & pieces(WHITE, PAWN)) |
+		       (Pieces::piece_attacks_s<KNIGHT>(sq) & pieces(KNIGHT)) |
+		       (Pieces::piece_attacks_s<BISHOP>(sq, occ) & pieces(BISHOP, QUEEN)) |
+		       (Pieces::piece_attacks_s<ROOK>(sq, occ) & pieces(ROOK, QUEEN)) |
+		       (Pieces::piece_attacks_s<KING>(sq) & pieces(KING));
     }
 
 
@@ -475,7 +705,7 @@ namespace Chessboard {
         uint16_t loops = m_pstack.top().irr_distance / 2;     
         
         for (int i = 1; i <= loops; i++) {
-            if (m_pstack.size() < 2 * i + 1)
+            if (m_pstack.size() < std::size_t(2 * i + 1))
                 break;
             
             // We assume that positions are the same if their hashes are equal, altrough it's not always true
@@ -489,12 +719,50 @@ namespace Chessboard {
         return std::make_pair(count, distance);
     }
 
+    bool Board::upcoming_repetition(uint16_t plies) const
+    {
+        // A cycle requires at least 3 reversible moves in a row, and can't go through null moves
+        int end = std::min({ int(irreversible_distance()), int(plies) - 1, int(m_pstack.size()) - 1 });
+
+        if (end < 3 || m_pstack.top().last_move == Moves::null)
+            return false;
+
+        Zobrist::Hash original_hash = m_pstack.top().hash;
+
+        // Hash difference of opponent's moves
+        // - If it's zero, opponent's pieces came back to the same squares, so the difference between positions comes only from
+        //   moves of side to move
+        Zobrist::Hash other = original_hash ^ m_pstack.top_n(1).hash ^ Zobrist::side_hash();
+
+        for (int i = 3; i <= end; i += 2) {
+            const Position& opponent_position = m_pstack.top_n(i - 1);
+            const Position& position = m_pstack.top_n(i);
+
+            if (m_pstack.top_n(i - 2).last_move == Moves::null || opponent_position.last_move == Moves::null)
+                return false;
+
+            other ^= opponent_position.hash ^ position.hash ^ Zobrist::side_hash();
+
+            if (other)
+                continue;
+
+            // Check whether a single reversible move leads from current position to the earlier one
+            Move move = Zobrist::cuckoo_move(original_hash ^ position.hash);
+
+            if (move != Moves::null && 
+                !(Paths[move.from()][move.to()] & ~square_to_bb(move.from()) & ~square_to_bb(move.to()) & pieces()))
+                return true;
+        }
+
+        return false;
+    }
+
 
     // -----------------------------------
     // Board - position analysis - threats
     // -----------------------------------
 
-    Bitboard Board::threats(Color side)
+    Bitboard Board::threats(Color side) const
     {
         // Piece maps
         Bitboard threat_map = 0;
@@ -503,7 +771,7 @@ namespace Chessboard {
         // - Defense map is static, while attack map is dynamically updated after considering threats for each piece type
         // - Attack map initially contains attacks on undefended squares and we simply add lower type attacks step by step
         Bitboard defense_map = attacks(side);
-        Bitboard attack_map = attacks(~side) & ~defense_map | attacks(~side, PAWN);
+        Bitboard attack_map = (attacks(~side) & ~defense_map) | attacks(~side, PAWN);
 
         // Threats against knights & bishops
         threat_map |= pieces(side, KNIGHT, BISHOP) & attack_map;
@@ -587,7 +855,8 @@ namespace Chessboard {
         else if (move.flags() & 0xb)
             return false;
         // Common moves - moving correctness
-        else if (!(Pieces::piece_attacks_d(type_of(piece), from, pieces()) & to))
+        // - Geometry comes from a lookup table, so only squares in between have to be checked for sliders
+        else if (!reachable(type_of(piece), from, to) || between(from, to) & pieces())
             return false;
 
         return true;
@@ -670,6 +939,14 @@ namespace Chessboard {
         // - attackdef is a map covering all pieces attacking given square (from both sides)
         // - possible_xray is a set of all sliding pieces and pawns
         Bitboard occ = pieces();
+
+        // Special case - enpassant
+        // - Captured pawn is not standing on target square, so it has to be taken into account separately
+        if (attacker == PAWN && file_of(from) != file_of(to) && on(to) == NO_PIECE) {
+            attacked = PAWN;
+            occ ^= make_square(rank_of(from), file_of(to));
+        }
+
         Bitboard attackdef = attackers_to(to, occ);
         Bitboard possible_xray = pieces() ^ pieces(KNIGHT) ^ pieces(KING);
 
@@ -679,6 +956,11 @@ namespace Chessboard {
         if (attacker == PAWN && file_of(from) == file_of(to))
             attackdef |= from;
 
+        // Special case - promotion
+        // - Piece that can be recaptured on target square is the promoted one, not the pawn
+        if (promote_to != PAWN)
+            attacker = promote_to;
+
         gain[depth] = Evaluation::PieceValues[attacked] + Evaluation::PieceValues[promote_to]
                                                         - Evaluation::PieceValues[PAWN];
 
@@ -711,6 +993,90 @@ namespace Chessboard {
 		return gain[m_moving_side];
     }
 
+    // SEE threshold test
+    // - Follows the same exchange sequence as see(), but keeps only the balance relative to the threshold
+    // - Each side stops capturing as soon as the balance settles on its side of the threshold
+    // - Unlike see(), it does not stop once the sign is settled, so bounds other than 0 are exact
+    // - It is also more precise than see(): pinned pieces recapture only along the pin line (as long as pinners are on board),
+    //   and king never recaptures on a square that is still defended
+    bool Board::see_ge(Square from, Square to, int32_t threshold, PieceType promote_to) const
+    {
+        // Null move does not change material balance
+        if (from == to)
+            return threshold <= 0;
+
+        // Piece standing on target square after the move (promoted piece in case of promotion)
+        PieceType attacker = promote_to != PAWN ? promote_to : type_of(on(from));
+        PieceType captured = type_of(on(to));
+        Bitboard occ = pieces() ^ from;
+
+        // Enpassant captures a pawn which is not standing on target square
+        if (type_of(on(from)) == PAWN && file_of(from) != file_of(to) && on(to) == NO_PIECE) {
+            captured = PAWN;
+            occ ^= make_square(rank_of(from), file_of(to));
+        }
+
+        // Balance after the first capture - if it does not reach the threshold, recaptures can only make it worse
+        int32_t swap = Evaluation::PieceValues[captured] + Evaluation::PieceValues[promote_to]
+                                                         - Evaluation::PieceValues[PAWN] - threshold;
+        if (swap < 0)
+            return false;
+
+        // Balance after losing the capturing piece - if it still reaches the threshold, nothing can make it worse
+        swap = Evaluation::PieceValues[attacker] - swap;
+        if (swap <= 0)
+            return true;
+
+        // - attackdef is a map covering all pieces attacking given square (from both sides)
+        // - Moving piece (and pawn captured enpassant) is removed from occupancy upfront, so sliders behind it are already included
+        Bitboard attackdef = attackers_to(to, occ);
+        Bitboard diagonal = pieces(BISHOP, QUEEN);
+        Bitboard orthogonal = pieces(ROOK, QUEEN);
+
+        // Pinned pieces may recapture only along the line connecting them with own king
+        Bitboard blocked[COLOR_RANGE] = { pinned(WHITE) & ~Lines[m_kings[WHITE]][to], pinned(BLACK) & ~Lines[m_kings[BLACK]][to] };
+
+        // Result is relative to side to move, and it is flipped with every capture
+        // - result = 1 means that the threshold is reached if the exchange stops here
+        Color side = m_moving_side;
+        int32_t result = 1;
+
+        while (true) {
+            side = ~side;
+            attackdef &= occ;
+
+            // Pins hold only as long as the pinning pieces stay on board
+            Bitboard candidates = attackdef & pieces(side);
+            if (pinners(~side) & occ)
+                candidates &= ~blocked[side];
+
+            from = lvp(*this, side, candidates, attacker);
+
+            if (from == NULL_SQUARE)
+                break;
+
+            result ^= 1;
+
+            // King cannot recapture if the square is still defended, so the previous result holds
+            if (attacker == KING)
+                return (attackdef & pieces(~side)) ? !result : result;
+
+            // Side which just captured stops, if losing the capturing piece would not change the outcome
+            swap = Evaluation::PieceValues[attacker] - swap;
+            if (swap < result)
+                break;
+
+            // Removing the capturing piece may uncover a slider standing behind it
+            occ ^= from;
+            if (Pieces::piece_attacks_s<BISHOP>(to) & from)
+                attackdef |= Pieces::piece_attacks_s<BISHOP>(to, occ) & diagonal;
+            else if (Pieces::piece_attacks_s<ROOK>(to) & from)
+                attackdef |= Pieces::piece_attacks_s<ROOK>(to, occ) & orthogonal;
+        }
+
+        return bool(result);
+    }
+
 
     // ----------------------------------------
     // Board - move analysis - other properties
@@ -721,8 +1087,10 @@ namespace Chessboard {
         Square from = move.from();
         Square to = move.to();
 
-        return m_pstack.top().check_areas[type_of(m_board[from])] & to ||
-               (m_pstack.top().discoveries[m_moving_side] & from &&
+        const PositionExtras& check_info = extras(CHECK_INFO);
+
+        return check_info.check_areas[type_of(m_board[from])] & to ||
+               (check_info.discoveries & from &&
                 !aligned_in_order(m_kings[~m_moving_side], to, from) &&
                 !aligned_in_order(m_kings[~m_moving_side], from, to));
     }
@@ -796,25 +1164,18 @@ namespace Chessboard {
         // To detect pieces that check the king, we can simply detect all attackers to king's position
         m_pstack.top().checkers = attackers_to(m_kings[m_moving_side], ~m_moving_side);
 
-        // Detecting check areas works similarly, but instead of aggregative attackers_to we use 
-        // specialized piece-attack functions.
-        m_pstack.top().check_areas[PAWN] = Pieces::pawn_attacks(~m_moving_side, m_kings[~m_moving_side]);
-	    m_pstack.top().check_areas[KNIGHT] = Pieces::piece_attacks_s<KNIGHT>(m_kings[~m_moving_side], pieces());
-	    m_pstack.top().check_areas[BISHOP] = Pieces::piece_attacks_s<BISHOP>(m_kings[~m_moving_side], pieces());
-	    m_pstack.top().check_areas[ROOK] = Pieces::piece_attacks_s<ROOK>(m_kings[~m_moving_side], pieces());
-	    m_pstack.top().check_areas[QUEEN] = m_pstack.top().check_areas[BISHOP] | 
-                                            m_pstack.top().check_areas[ROOK];
+        // Pins against side to move are required by legal move generation, so they are also updated eagerly
+        Bitboard pinners, discoveries;
+        find_pins(m_moving_side, m_pstack.top().pinned, pinners, discoveries);
     }
 
-    void Board::update_pins(Color side)
+    void Board::find_pins(Color side, Bitboard& pinned, Bitboard& pinners, Bitboard& discoveries) const
     {
         // For readability
         Color enemy = ~side;
 
-        // Reset relevant tables first
-        m_pstack.top().pinned[side] = 0;
-        m_pstack.top().pinners[enemy] = 0;
-        m_pstack.top().discoveries[enemy] = 0;
+        // Reset results first
+        pinned = pinners = discoveries = 0;
 
         // We can express pin as a some sort of an x-ray attack, but with piece of opposite color as a blocker
         // - NOTE: Here we also take discovered attack into consideretion (x-ray with same side piece as a blocker)
@@ -828,57 +1189,125 @@ namespace Chessboard {
 
             // Potential discovery
             if (discovery)
-                m_pstack.top().discoveries[enemy] |= discovery;
+                discoveries |= discovery;
             // If it's not a potential discovery, then it's a pin
             else {
-                m_pstack.top().pinned[side] |= Paths[m_kings[side]][sq] & pieces(side);
-                m_pstack.top().pinners[enemy] |= sq;
+                pinned |= Paths[m_kings[side]][sq] & pieces(side);
+                pinners |= sq;
             }
         }
 
         // Discard king square from pin set, since king cannot be pinned
         // - The above algorithm can incorrectly classify king as pinned in case of a check
-        m_pstack.top().pinned[side] &= ~m_kings[side];
+        pinned &= ~m_kings[side];
     }
 
 
-    // ---------------------------------------------
-    // Board - helper functions - attack maps update
-    // ---------------------------------------------
+    // ---------------------------------------
+    // Board - helper functions - lazy updates
+    // ---------------------------------------
+
+    void Board::update_check_info() const
+    {
+        PositionExtras& extras = m_xstack.top();
+
+        // Detecting check areas works similarly to detecting checkers, but instead of aggregative attackers_to we use 
+        // specialized piece-attack functions.
+        extras.check_areas[PAWN] = Pieces::pawn_attacks(~m_moving_side, m_kings[~m_moving_side]);
+	    extras.check_areas[KNIGHT] = Pieces::piece_attacks_s<KNIGHT>(m_kings[~m_moving_side], pieces());
+	    extras.check_areas[BISHOP] = Pieces::piece_attacks_s<BISHOP>(m_kings[~m_moving_side], pieces());
+	    extras.check_areas[ROOK] = Pieces::piece_attacks_s<ROOK>(m_kings[~m_moving_side], pieces());
+	    extras.check_areas[QUEEN] = extras.check_areas[BISHOP] | extras.check_areas[ROOK];
+
+        // Discoveries of side to move are x-rays against the enemy king
+        Bitboard pinned, pinners;
+        find_pins(~m_moving_side, pinned, pinners, extras.discoveries);
+    }
 
-    void Board::update_attacks()
+    void Board::update_pin_info() const
     {
+        PositionExtras& extras = m_xstack.top();
+        Bitboard discoveries;
+
+        find_pins(WHITE, extras.pinned[WHITE], extras.pinners[BLACK], discoveries);
+        find_pins(BLACK, extras.pinned[BLACK], extras.pinners[WHITE], discoveries);
+    }
+
+    void Board::update_attacks() const
+    {
+        PositionExtras& extras = m_xstack.top();
+
+        // Incremental update
+        // - If attack maps of previous ply are available, only slider attacks affected by the last move have to be recalculated
+        // - Slider attacks change only if the move changed occupancy of any square they reach, or changed the sliders themselves
+        // - Pawns, knights and kings are recalculated anyway, since aggregative calculations are cheaper than any checks
+        bool incremental = m_pstack.size() > 1 && m_pstack.top_n(1).extras_ready & ATTACK_INFO;
+        Bitboard changed = 0;
+
+        if (incremental) {
+            Move move = m_pstack.top().last_move;
+
+            // Null move changes nothing, so empty set of changed squares is fine
+            if (move != Moves::null) {
+                changed = square_to_bb(move.from()) | move.to();
+                if (move.is_enpassant())
+                    changed |= m_pstack.top_n(1).enpassant_square;
+                else if (move.is_castle())
+                    changed |= square_to_bb(make_square(rank_of(move.to()), file_of(move.to()) == ::FILE_G ? ::FILE_H : ::FILE_A)) |
+                               square_to_bb(make_square(rank_of(move.to()), file_of(move.to()) == ::FILE_G ? ::FILE_F : ::FILE_D));
+            }
+        }
+
         // Update for both sides
         for (unsigned side = WHITE; side <= BLACK; side++) {
             // Pawns, knights and kings can be covered separately using aggregative attack calculations
-            m_pstack.top().attacks[side][PAWN] = side == WHITE ? Pieces::pawn_attacks<WHITE>(pieces(WHITE, PAWN)) :
-                                                                 Pieces::pawn_attacks<BLACK>(pieces(BLACK, PAWN));
-            m_pstack.top().attacks[side][KNIGHT] = Pieces::knight_attacks(pieces(Color(side), KNIGHT));
-            m_pstack.top().attacks[side][KING] = Pieces::piece_attacks_s<KING>(king_position(Color(side)));
+            extras.attacks[side][PAWN] = side == WHITE ? Pieces::pawn_attacks<WHITE>(pieces(WHITE, PAWN)) :
+                                                         Pieces::pawn_attacks<BLACK>(pieces(BLACK, PAWN));
+            extras.attacks[side][KNIGHT] = Pieces::knight_attacks(pieces(Color(side), KNIGHT));
+            extras.attacks[side][KING] = Pieces::piece_attacks_s<KING>(king_position(Color(side)));
+
+            // Sliders of given type are affected if any of them stands on changed square, was captured, 
+            // or their attacks reach any of changed squares
+            auto unaffected = [&](PieceType ptype) {
+                if (incremental &&
+                    !(m_xstack.top_n(1).attacks[side][ptype] & changed) &&
+                    !(pieces(Color(side), ptype) & changed) &&
+                    m_pstack.top().captured != make_piece(Color(side), ptype))
+                {
+                    extras.attacks[side][ptype] = m_xstack.top_n(1).attacks[side][ptype];
+                    return true;
+                }
+                extras.attacks[side][ptype] = 0;
+                return false;
+            };
 
             // For sliding piece attacks, we need to cover each piece indyvidualy
-            Bitboard bishops = pieces(Color(side), BISHOP);
-            while (bishops)
-                m_pstack.top().attacks[side][BISHOP] |= Pieces::piece_attacks_s<BISHOP>(Bitboards::pop_lsb(bishops), pieces());
+            if (!unaffected(BISHOP)) {
+                Bitboard bishops = pieces(Color(side), BISHOP);
+                while (bishops)
+                    extras.attacks[side][BISHOP] |= Pieces::piece_attacks_s<BISHOP>(Bitboards::pop_lsb(bishops), pieces());
+            }
             
-            Bitboard rooks = pieces(Color(side), ROOK);
-            while (rooks)
-                m_pstack.top().attacks[side][ROOK] |= Pieces::piece_attacks_s<ROOK>(Bitboards::pop_lsb(rooks), pieces());
+            if (!unaffected(ROOK)) {
+                Bitboard rooks = pieces(Color(side), ROOK);
+                while (rooks)
+                    extras.attacks[side][ROOK] |= Pieces::piece_attacks_s<ROOK>(Bitboards::pop_lsb(rooks), pieces());
+            }
 
-            Bitboard queens = pieces(Color(side), QUEEN);
-            while (queens)
-                m_pstack.top().attacks[side][QUEEN] |= Pieces::piece_attacks_s<QUEEN>(Bitboards::pop_lsb(queens), pieces());
+            if (!unaffected(QUEEN)) {
+                Bitboard queens = pieces(Color(side), QUEEN);
+                while (queens)
+                    extras.attacks[side][QUEEN] |= Pieces::piece_attacks_s<QUEEN>(Bitboards::pop_lsb(queens), pieces());
+            }
             
             // Finally, calculate all piece attack map
-            m_pstack.top().attacks[side][ALL_PIECES] = m_pstack.top().attacks[side][PAWN] |
-                                                       m_pstack.top().attacks[side][KNIGHT] |
-                                                       m_pstack.top().attacks[side][BISHOP] |
-                                                       m_pstack.top().attacks[side][ROOK] |
-                                                       m_pstack.top().attacks[side][QUEEN] |
-                                                       m_pstack.top().attacks[side][KING];
+            extras.attacks[side][ALL_PIECES] = extras.attacks[side][PAWN] |
+                                               extras.attacks[side][KNIGHT] |
+                                               extras.attacks[side][BISHOP] |
+                                               extras.attacks[side][ROOK] |
+                                               extras.attacks[side][QUEEN] |
+                                               extras.attacks[side][KING];
         }
-
-        m_pstack.top().attacks_ready = true;
     }
 
 
@@ -896,11 +1325,11 @@ namespace Chessboard {
                castling_rights() == other.castling_rights() &&
                enpassant_square() == other.enpassant_square() &&
                checkers() == other.checkers() &&
-               std::equal(m_pstack.top().check_areas, m_pstack.top().check_areas + PIECE_TYPE_RANGE, other.m_pstack.top().check_areas) &&
-               std::equal(m_pstack.top().discoveries, m_pstack.top().discoveries + COLOR_RANGE, other.m_pstack.top().discoveries) &&
-               std::equal(m_pstack.top().pinned, m_pstack.top().pinned + COLOR_RANGE, other.m_pstack.top().pinned) &&
-               std::equal(m_pstack.top().pinners, m_pstack.top().pinners + COLOR_RANGE, other.m_pstack.top().pinners) &&
-               game_stage() == other.game_stage();
+               std::equal(extras(CHECK_INFO).check_areas, extras(CHECK_INFO).check_areas + PIECE_TYPE_RANGE, other.extras(CHECK_INFO).check_areas) &&
+               extras(CHECK_INFO).discoveries == other.extras(CHECK_INFO).discoveries &&
+               pinned(WHITE) == other.pinned(WHITE) && pinned(BLACK) == other.pinned(BLACK) &&
+               pinners(WHITE) == other.pinners(WHITE) && pinners(BLACK) == other.pinners(BLACK) &&
+               material_key() == other.material_key();
     }
 
 
@@ -917,7 +1346,7 @@ namespace Chessboard {
         for (int r = ::RANK_8; r >= 0; r--) {
             int gap = 0;
 
-            for (int f = ::FILE_A; f <= ::FILE_H; f++) {
+            for (uint32_t f = ::FILE_A; f <= ::FILE_H; f++) {
                 Piece piece = m_board[make_square(Rank(r), File(f))];
 
                 if (piece != NO_PIECE) {
@@ -972,4 +1401,80 @@ namespace Chessboard {
         return fen.str();
     }
 
+
+    // -----------------------
+    // Board state - copy-make
+    // -----------------------
+
+    // Move maker targets - compact states
+    // - Next state starts as a copy of the previous one, and the shared move makers update it in place
+    struct Board::StateTarget
+    {
+        const BoardState& prev;
+        BoardState& next;
+        Zobrist::Zobrist zobrist;
+
+        StateTarget(const BoardState& prev, BoardState& next) : prev(prev), next(next) { zobrist.set(prev.hash); }
+
+        // Position analysis
+        Piece on(Square sq) const { return Piece(next.board[sq]); }
+        Bitboard pieces(Color side, PieceType ptype) const { return next.pieces_c[side] & next.pieces_t[ptype]; }
+        Color side() const { return Color(prev.side_to_move); }
+
+        // Piece placement & hash updates
+        // - Same semantics as Board piece placement handlers
+        void place_piece(Piece piece, Square sq) {
+            next.board[sq] = uint8_t(piece);
+            next.pieces_c[color_of(piece)] |= sq;
+            next.pieces_t[type_of(piece)] |= sq;
+            next.pieces_t[ALL_PIECES] |= sq;
+
+            if (type_of(piece) == KING)
+                next.kings[color_of(piece)] = uint8_t(sq);
+        }
+        void remove_piece(Square sq) {
+            Piece piece = on(sq);
+
+            next.board[sq] = uint8_t(NO_PIECE);
+            next.pieces_c[color_of(piece)] ^= sq;
+            next.pieces_t[type_of(piece)] ^= sq;
+            next.pieces_t[ALL_PIECES] ^= sq;
+        }
+        void move_piece(Square from, Square to) {
+            Piece piece = on(from);
+            Bitboard movemap = square_to_bb(from) | square_to_bb(to);
+
+            next.board[from] = uint8_t(NO_PIECE);
+            next.board[to] = uint8_t(piece);
+            next.pieces_c[color_of(piece)] ^= movemap;
+            next.pieces_t[type_of(piece)] ^= movemap;
+            next.pieces_t[ALL_PIECES] ^= movemap;
+
+            if (type_of(piece) == KING)
+                next.kings[color_of(piece)] = uint8_t(to);
+        }
+        template <typename... Args>
+        void update_hash(Args... args) { zobrist.update(args...); }
+
+        // States have no history, so there is nothing to remember for unmake or repetitions
+        void set_captured(Piece) {}
+        void set_irreversible(bool) {}
+    };
+
+    BoardState make_move(const BoardState& state, const Move& move)
+    {
+        BoardState next = state;
+
+        Board::StateTarget target(state, next);
+        Board::make_pieces(target, move);
+
+        // Side to move change, halfmove counter & hash update
+        next.side_to_move = uint8_t(~Color(state.side_to_move));
+        target.update_hash(Color(next.side_to_move));
+        next.halfmoves++;
+        next.hash = target.zobrist.hash();
+
+        return next;
+    }
+
 }
\ No newline at end of file
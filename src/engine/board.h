@@ -2,11 +2,13 @@
 
 #include "boardspace.h"
 #include "boardlogic.h"
+#include "material.h"
 #include "moves.h"
 #include "pieces.h"
 #include "zobrist.h"
 #include "../utilities/sstack.h"
 #include <stack>
+#include <type_traits>
 #include <vector>
 
 
@@ -27,6 +29,68 @@ namespace Chessboard {
     const std::string STARTING_POSITION = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
 
+    // -------------------------------
+    // Board state - compact snapshot
+    // -------------------------------
+
+    // Trivially copyable snapshot of a single position, without any move history
+    // - Allows to hand positions over to worker threads or batch workloads, and to apply moves in copy-make fashion
+    // - Move generation and position analysis still work on Board, so state should be loaded into a board first
+    // - Checks & pins are not stored, since they are calculated anyway when the state is loaded into a board
+    // - Small fields are narrowed to bytes to keep the whole state compact (copy cost is the main cost of copy-make),
+    //   except for the fields which are updated by move makers shared with Board
+    struct BoardState
+    {
+        // Piece placement
+        uint8_t board[SQUARE_RANGE];                // Mailbox (Piece values)
+        Bitboard pieces_t[PIECE_TYPE_RANGE];
+        Bitboard pieces_c[COLOR_RANGE];
+
+        // Keys
+        Zobrist::Hash hash;
+        Zobrist::Hash pawn_hash;
+        Evaluation::MaterialKey material_key;
+
+        // Special aspects
+        CastlingRights castling_rights;
+        Square enpassant_square;
+
+        // Move counting
+        uint16_t halfmoves;
+        uint16_t halfmove_clock;
+
+        // Other
+        uint8_t kings[COLOR_RANGE];
+        uint8_t side_to_move;
+    };
+
+    static_assert(std::is_trivially_copyable_v<BoardState>);
+
+
+    // ---------------------------------
+    // Packed position - binary encoding
+    // ---------------------------------
+
+    // Fixed size binary encoding of a position, designed for storing and shipping large amounts of positions
+    // - Pieces are encoded as occupancy bitboard followed by 4-bit piece codes (Piece values) in occupancy order (from A1 to H8)
+    // - Legal position has at most 32 pieces, so 16 bytes of piece codes is always enough
+    // - Only position itself is encoded (no move history)
+    // - Encoding and decoding throw std::invalid_argument for positions which do not fit into the format (too many pieces,
+    //   invalid piece codes, missing or extra kings)
+    struct PackedPosition
+    {
+        Bitboard occupancy;
+        uint8_t pieces[16];             // Piece codes, 2 per byte (lower nibble first)
+        uint16_t halfmoves;             // Plain counter of halfmoves (halfmoves_p())
+        uint8_t halfmove_clock;         // Clock counter of halfmoves - 50 move rule is reached before it overflows
+        uint8_t flags;                  // Side to move (bit 4) and castling rights (bits 0-3)
+        uint8_t enpassant_square;       // Enpassant square or NULL_SQUARE
+        uint8_t padding[3] = { 0 };
+    };
+
+    static_assert(sizeof(PackedPosition) == 32);
+
+
     // --------------------
     // Board representation
     // --------------------
@@ -41,6 +105,17 @@ namespace Chessboard {
         void load_position() { load_position(STARTING_POSITION); }  // Loads starting position
         void load_position(const std::string& fen);                 // Loads position from given FEN notation
         void load_position(const Board& other);                     // Loads position from different Board object
+        void load_position(const BoardState& state);                // Loads position from compact state (without history)
+        void load_position(const PackedPosition& packed);           // Loads position from binary encoding (without history)
+
+        // Position export - compact state & binary encoding
+        // - Reverse operations to load_position(state) and load_position(packed)
+        BoardState state() const;
+        PackedPosition encode() const;
+
+        // Position history capacity
+        // - Position stack grows automatically, but reallocation is slow, so searching boards should reserve enough plies upfront
+        void reserve(std::size_t plies) { m_pstack.reserve(plies); m_xstack.reserve(plies); }
 
         // Position change - dynamic - move make & unmake
         // - Most of data is placed on the stack to provide quick, reversible position change operation
@@ -57,11 +132,8 @@ namespace Chessboard {
         template <typename... PieceTypes>
         Bitboard pieces(Color side, PieceTypes... types) const { return pieces(side) & pieces(types...); }
         Square king_position(Color side) const { return m_kings[side]; }
-        Bitboard attacks(Color side, PieceType ptype) { 
-            if (!m_pstack.top().attacks_ready) update_attacks();
-            return m_pstack.top().attacks[side][ptype];
-        }
-        Bitboard attacks(Color side) { return attacks(side, ALL_PIECES); }
+        Bitboard attacks(Color side, PieceType ptype) const { return extras(ATTACK_INFO).attacks[side][ptype]; }
+        Bitboard attacks(Color side) const { return attacks(side, ALL_PIECES); }
 
         // Position analysis - square-centric operations
         Piece on(Square sq) const { return m_board[sq]; }
@@ -73,11 +145,12 @@ namespace Chessboard {
 
         // Position analysis - checks & pins
         // - NOTE: all of those methods assumes that position is legal and only side to move can be in check or give a check
+        // - Checkers and pins of side to move are updated with every move, the rest is calculated on first use
         bool in_check() const { return m_pstack.top().checkers; }
         Bitboard checkers() const { return m_pstack.top().checkers; }
-        Bitboard possible_checks(PieceType ptype) const { return m_pstack.top().check_areas[ptype]; }
-        Bitboard pinned(Color side) const { return m_pstack.top().pinned[side]; }
-        Bitboard pinners(Color side) const { return m_pstack.top().pinners[side]; }
+        Bitboard possible_checks(PieceType ptype) const { return extras(CHECK_INFO).check_areas[ptype]; }
+        Bitboard pinned(Color side) const { return side == m_moving_side ? m_pstack.top().pinned : extras(PIN_INFO).pinned[side]; }
+        Bitboard pinners(Color side) const { return extras(PIN_INFO).pinners[side]; }
 
         // Position analysis - special properties
         // - can_castle() checks only whether given side has appropriate castling rights (does not check legality of castling)
@@ -102,17 +175,23 @@ namespace Chessboard {
         // - It breaks the single responsibility rule, but is a little bit faster than 2 separate functions
         std::pair<uint16_t, uint16_t> repetitions() const;           // (count, distance)
 
+        // Position analysis - upcoming repetitions
+        // - Detects whether side to move has a reversible move that repeats some earlier position (cuckoo tables)
+        // - Only positions reached in less than given number of plies are considered (for example, plies since search root),
+        //   since only those count as a draw after a single repetition
+        bool upcoming_repetition(uint16_t plies) const;
+
         // Position analysis - threats
         // - Threat (piece-wise) is an attack against undefended piece, or piece of higher value (foe example, a knight attacking a rook)
         // - threats() returns map of threats (pieces) against given side
-        // - NOTE: these methods cannot be const, since calculating attack maps might affect attack tables (lazy updates)
-        Bitboard threats(Color side);
-        unsigned count_threats(Color side) { return Bitboards::popcount(threats(side)); }
+        Bitboard threats(Color side) const;
+        unsigned count_threats(Color side) const { return Bitboards::popcount(threats(side)); }
 
         // Position analysis - other
         Color side_to_move() const { return m_moving_side; }
-        uint16_t game_stage() const { return m_pstack.top().game_stage; }
         Zobrist::Hash hash() const { return m_zobrist.hash(); }
+        Zobrist::Hash pawn_hash() const { return m_pstack.top().pawn_hash; }
+        Evaluation::MaterialKey material_key() const { return m_pstack.top().material_key; }
         Move last_move() const { return m_pstack.top().last_move; }
 
         // Move analysis - legaity checks
@@ -129,6 +208,14 @@ namespace Chessboard {
         int32_t see(Square from, Square to, PieceType promote_to = PAWN) const;
         int32_t see(const Move& move) const { return see(move.from(), move.to(), move.is_promotion() ? move.promotion_type() : PAWN); }
 
+        // Move analysis - SEE threshold test
+        // - Tests whether the exchange on the target square wins at least threshold, exiting as soon as the outcome is known
+        // - Agrees with the sign of see(...) for thresholds 0 and 1, preferred whenever only the sign (or a bound) of SEE is needed
+        bool see_ge(Square from, Square to, int32_t threshold, PieceType promote_to = PAWN) const;
+        bool see_ge(const Move& move, int32_t threshold) const {
+            return see_ge(move.from(), move.to(), threshold, move.is_promotion() ? move.promotion_type() : PAWN);
+        }
+
         // Move analysis - other properties
         bool is_check(const Move& move) const;
 
@@ -151,10 +238,18 @@ namespace Chessboard {
         
     private:
         // Helper functions - move makers
-        void make_normal(const Move& move);
-        void make_promotion(const Move& move);
-        void make_enpassant(const Move& move);
-        void make_castle(const Move& move);
+        // - Shared by make & unmake and by copy-make, target decides where the position is read from and written to
+        // - StackTarget works on the board itself (previous and next ply on position stack), StateTarget on a pair of compact states
+        struct StackTarget;
+        struct StateTarget;
+
+        template <typename Target> static void make_pieces(Target& target, const Move& move);  // Dispatches to specialized makers
+        template <typename Target> static void make_normal(Target& target, const Move& move);
+        template <typename Target> static void make_promotion(Target& target, const Move& move);
+        template <typename Target> static void make_enpassant(Target& target, const Move& move);
+        template <typename Target> static void make_castle(Target& target, const Move& move);
+
+        friend BoardState make_move(const BoardState& state, const Move& move);
 
         // Helper functions - piece placement handlers
         void place_piece(Piece piece, Square sq);
@@ -163,12 +258,16 @@ namespace Chessboard {
 
         // Helper functions - checks & pins update
         // - NOTE: By pins for given side we mean pins that affect given side, not pins caused by the side
-        void update_checks();                     // Updates all check informations for side to move
-        void update_pins(Color side);             // Updates all pin related information (pins, pinners, discoveries) for given side
+        void update_checks();                     // Updates checkers and pinned pieces of side to move (eager part)
+        void find_pins(Color side, Bitboard& pinned, Bitboard& pinners, Bitboard& discoveries) const;  // Pins, enemy pinners & discoveries
 
-        // Helper functions - attack maps update
-        // - Updates attack maps for both sides
-        void update_attacks();
+        // Helper functions - lazy updates
+        // - update_check_info() calculates check areas and discoveries for side to move
+        // - update_pin_info() calculates pins and pinners for both sides
+        // - update_attacks() calculates attack maps for both sides
+        void update_check_info() const;
+        void update_pin_info() const;
+        void update_attacks() const;
 
         // Common data
         // - Single instances inside Board class
@@ -202,16 +301,9 @@ namespace Chessboard {
             Piece captured = NO_PIECE;
 
             // Position data - checks & pins
-            Bitboard checkers = 0ULL;							// Map of pieces that currently give a check (against side to move)
-	        Bitboard check_areas[PIECE_TYPE_RANGE] = { 0ULL };	// Map of possible checks for current side to move pieces
-	        Bitboard discoveries[COLOR_RANGE] = { 0ULL };		// Map of squares occupied by pieces which could cause a discovered check (for both sides)
-	        Bitboard pinned[COLOR_RANGE] = { 0ULL };			// Map of pinned pieces (for both sides)
-	        Bitboard pinners[COLOR_RANGE] = { 0ULL };			// Map of pieces that pin at least one of enemy's pieces ( for both sides)
-
-            // Position data - attack maps
-            // - This is a little bit more expensive to calculate, so we apply lazy updates (tables are updated only when needed)
-            bool attacks_ready = false;
-            Bitboard attacks[COLOR_RANGE][PIECE_TYPE_RANGE] = { 0ULL };             // Map of all attacks
+            // - Only the data required by legal move generation is updated eagerly (side to move only)
+            Bitboard checkers = 0ULL;       // Map of pieces that currently give a check (against side to move)
+            Bitboard pinned = 0ULL;         // Map of pinned pieces of side to move
 
             // Position data - special aspects
             CastlingRights castling_rights = NO_CASTLING;
@@ -220,21 +312,73 @@ namespace Chessboard {
             // Position data - miscellaneous
             uint16_t halfmove_clock = 0;                   // Halfmove clock (resets after every irreversible move)
             uint16_t irr_distance = 0;                     // Irreversible distance - distance (in plies) from last irreversible move
-            uint16_t game_stage = 0;
+
+            // Position data - material
+            // - Material key changes only with captures and promotions, so it's updated incrementally by move makers
+            Evaluation::MaterialKey material_key = 0;
+
+            // Lazy data flags
+            // - Indicates which parts of PositionExtras are already calculated for this ply (reset with every move)
+            mutable uint8_t extras_ready = 0;
 
             // Position data - hash
             // - Storing hash allows us to quickly reset Zobrist object without performing all the operations
+            // - Pawn hash covers only pawn placement and is updated incrementally by move makers
             Zobrist::Hash hash = 0;
+            Zobrist::Hash pawn_hash = 0;
         };
 
+        // Individual data - lazily calculated extras
+        // - Data that is expensive to calculate and rarely needed, so it's calculated on first use only
+        // - Kept outside of Position structure, so that make & unmake touches as little memory as possible
+        enum ExtrasPart : uint8_t { CHECK_INFO = 1, PIN_INFO = 2, ATTACK_INFO = 4 };
+
+        struct PositionExtras
+        {
+            // CHECK_INFO - checks that side to move could give
+	        Bitboard check_areas[PIECE_TYPE_RANGE] = { 0ULL };	// Map of possible checks for current side to move pieces
+            Bitboard discoveries = 0ULL;                        // Map of side to move pieces which could cause a discovered check
+
+            // PIN_INFO - pins for both sides
+	        Bitboard pinned[COLOR_RANGE] = { 0ULL };			// Map of pinned pieces (for both sides)
+	        Bitboard pinners[COLOR_RANGE] = { 0ULL };			// Map of pieces that pin at least one of enemy's pieces (for both sides)
+
+            // ATTACK_INFO - attack maps for both sides
+            Bitboard attacks[COLOR_RANGE][PIECE_TYPE_RANGE] = { 0ULL };
+        };
+
+        // Lazy data getter
+        // - Calculates requested part of extras if it's not ready yet
+        const PositionExtras& extras(ExtrasPart part) const {
+            if (!(m_pstack.top().extras_ready & part)) {
+                if (part == CHECK_INFO) update_check_info();
+                else if (part == PIN_INFO) update_pin_info();
+                else update_attacks();
+                m_pstack.top().extras_ready |= part;
+            }
+            return m_xstack.top();
+        }
+
         // Individual data - unique for each ply
         // - Stack data structure, each element represents a single ply data
+        // - Extras stack is kept in sync with position stack
         StableStack<Position> m_pstack;
+        mutable StableStack<PositionExtras> m_xstack;
 
         // Hashing mechanism
         Zobrist::Zobrist m_zobrist;
     };
 
+
+    // -----------------------
+    // Board state - copy-make
+    // -----------------------
+
+    // Returns a state of position reached after making given move in given state
+    // - Copy-make alternative for make & unmake, which does not require any history stack
+    // - Shares move makers with Board, so the results are always identical
+    BoardState make_move(const BoardState& state, const Move& move);
+
 }
 
 // Share commong usages from Chessboard namespace
@@ -11,6 +11,7 @@ namespace Chessboard {
     Bitboard Paths[SQUARE_RANGE][SQUARE_RANGE] = { 0 };
     Bitboard Lines[SQUARE_RANGE][SQUARE_RANGE] = { 0 };
 	Bitboard Boxes[SQUARE_RANGE][SQUARE_RANGE] = { 0 };
+    uint8_t Reaches[SQUARE_RANGE][SQUARE_RANGE] = { 0 };
     Bitboard Vspans[SQUARE_RANGE][2] = { 0 };
     Bitboard Hspans[SQUARE_RANGE][2] = { 0 };
 
@@ -53,11 +54,31 @@ namespace Chessboard {
         Boxes[sq1][sq2] = fill1 & fill2;
     }
 
+    // Helper function nr 3
+    // - Reaches are derived from file & rank distances, apart from sliders which simply follow lines
+    void calculate_reaches(Square sq1, Square sq2)
+    {
+        int df = std::abs(int(file_of(sq2)) - int(file_of(sq1)));
+        int dr = std::abs(int(rank_of(sq2)) - int(rank_of(sq1)));
+
+        uint8_t reach = 0;
+        if (df * dr == 2)
+            reach |= 1 << KNIGHT;
+        if (df == dr)
+            reach |= (1 << BISHOP) | (1 << QUEEN);
+        if (df == 0 || dr == 0)
+            reach |= (1 << ROOK) | (1 << QUEEN);
+        if (std::max(df, dr) == 1)
+            reach |= 1 << KING;
+
+        Reaches[sq1][sq2] = reach;
+    }
+
     // Main iniitializer
     void initialize_board_space()
     {
         // Iterate over every possible square
-        for (int sq1 = 0; sq1 < SQUARE_RANGE; sq1++) {
+        for (uint32_t sq1 = 0; sq1 < SQUARE_RANGE; sq1++) {
             // 1. Calculate properties that require only one square as input information
 
             // Vertical spans - 0 for south, 1 for north
@@ -71,7 +92,7 @@ namespace Chessboard {
             Hspans[sq1][1] = Bitboards::fill<EAST>(file_surrounding) ^ file_surrounding;
 
             // 2. Iterate again over every square and calculate pair properties
-            for (int sq2 = 0; sq2 < SQUARE_RANGE; sq2++) {
+            for (uint32_t sq2 = 0; sq2 < SQUARE_RANGE; sq2++) {
                 // Special case - sq1 = sq2
                 if (sq1 == sq2) {
                     Paths[sq1][sq2] = square_to_bb(Square(sq1));
@@ -84,6 +105,9 @@ namespace Chessboard {
 
                     // Boxes
                     calculate_boxes(Square(sq1), Square(sq2));
+
+                    // Reaches
+                    calculate_reaches(Square(sq1), Square(sq2));
                 }
             }
         }
@@ -166,6 +166,27 @@ namespace Chessboard {
     }
 
 
+    // ----------------------------------
+	// Board geometry - complex - reaches
+	// ----------------------------------
+
+    // Predefined lookup table for piece reaches
+    // - Each entry is a set of piece types (one bit per PieceType) that can move from sq1 to sq2 on an empty board
+    // - Pawns are not included, since their moves depend on color and move type
+    extern uint8_t Reaches[SQUARE_RANGE][SQUARE_RANGE];
+
+    inline bool reachable(PieceType ptype, Square from, Square to)
+    {
+        return Reaches[from][to] & (1 << ptype);
+    }
+
+    // Squares strictly between two aligned squares (empty set if squares are not aligned)
+    inline Bitboard between(Square sq1, Square sq2)
+    {
+        return Paths[sq1][sq2] & ~(square_to_bb(sq1) | sq2);
+    }
+
+
     // --------------------------------
 	// Board geometry - complex - boxes
 	// --------------------------------
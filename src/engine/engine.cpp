@@ -1,6 +1,8 @@
 #include "engine.h"
 #include "searchconfig.h"
 #include <chrono>
+#include <cmath>
+#include <exception>
 #include <memory>
 
 
@@ -9,67 +11,149 @@
 // -----------------------------
 
 std::pair<Search::Score, Move> Engine::evaluate(Search::Depth depth)
+{
+    // Step 0 - swap in a new network if it has been loaded in the meantime
+    // - Failed load must not interrupt the search, so the current network is kept and the error is only stored
+    try {
+        update_network();
+    }
+    catch (const std::exception&) {}
+
+    return crawl([&](auto& crawler) { return evaluate(crawler, depth); });
+}
+
+template <typename CrawlerT>
+std::pair<Search::Score, Move> Engine::evaluate(CrawlerT& crawler, Search::Depth depth)
 {
     // Step 1 - save current search position
-    m_mem_board = *m_crawler.get_position();
+    m_mem_board = *crawler.get_position();
 
     // Step 2 - main search
-    Search::Score result = 0;
-    Move best_move;
-
-    // depth == 0 case is equivalent to evaluating the position statically
+    // - depth == 0 case is equivalent to evaluating the position statically
     if (depth == 0)
-        result = Evaluation::relative_eval(m_crawler.search(0), *m_crawler.get_position());
-    else if (m_mode == Engine::Mode::STANDARD) {
-        result = Evaluation::relative_eval(iterative_deepening(depth), *m_crawler.get_position());
-        best_move = m_crawler.m_search_stack[1].best_move;
-    }
-    else if (m_mode == Engine::Mode::TRACE) {
-        result = Evaluation::relative_eval(iterative_deepening(depth), *m_crawler.get_position());
-        best_move = m_crawler.m_search_stack[1].best_move;
+        return std::make_pair(Evaluation::relative_eval(crawler.search(0), *crawler.get_position()), Moves::null);
+
+    auto start = std::chrono::steady_clock::now();
+    Search::Score result = Evaluation::relative_eval(iterative_deepening(crawler, depth), *crawler.get_position());
+    Move best_move = crawler.m_search_stack[1].best_move;
+    auto end = std::chrono::steady_clock::now();
 
-        const Board* board = m_crawler.get_position();
+    // Step 3 - search summary
+    if (m_mode == Engine::Mode::TRACE) {
+        const Board* board = crawler.get_position();
         const TranspositionTable::Entry* entry = m_ttable.probe(board->hash(), board->pieces());
 
         std::cout << "\n|||||   Search results   |||||\n";
         std::cout << std::dec << "Score: " << Evaluation::relative_eval(entry->score, *board);
-        std::cout << ", Type: " << int(m_crawler.m_search_stack[1].node) << 
+        std::cout << ", Type: " << int(crawler.m_search_stack[1].node) << 
                      ", Best move: " << best_move << "\n";
 
         if (!entry) {
             std::cout << "Missing TT entry!!!\n";
         }
     }
-    else {
-        auto start = std::chrono::steady_clock::now();
-        result = Evaluation::relative_eval(iterative_deepening(depth), *m_crawler.get_position());
-        best_move = m_crawler.m_search_stack[1].best_move;
-        auto end = std::chrono::steady_clock::now();
+
+    if constexpr (CrawlerT::Statistics::enabled) {
+        // Statistics of all the crawlers are aggregated (there is only one crawler for now)
+        Search::SearchStats stats;
+        stats += crawler.stats();
 
         auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
 
         std::cout << "Total search time: " << duration_ms.count() << " [ms]\n";
-        std::cout << "> Nodes per second: " << (long long) (m_crawler.non_leaf_nodes + m_crawler.qs_nodes) * 1000 / duration_ms.count() << "\n";
-        std::cout << "> Non-leaf nodes: " << m_crawler.non_leaf_nodes << "\n";
-        std::cout << "> Leaf nodes: " << m_crawler.leaf_nodes << "\n";
-        std::cout << "> Queiescence nodes: " << m_crawler.qs_nodes << "\n";
+        std::cout << "> Nodes per second: " << (long long) (stats.non_leaf_nodes + stats.qs_nodes) * 1000 / duration_ms.count() << "\n";
+        std::cout << "> Non-leaf nodes: " << stats.non_leaf_nodes << "\n";
+        std::cout << "> Leaf nodes: " << stats.leaf_nodes << "\n";
+        std::cout << "> Queiescence nodes: " << stats.qs_nodes << "\n";
+        std::cout << "> Effective branching factor: " << std::pow(double(stats.non_leaf_nodes + stats.leaf_nodes), 1.0 / depth) << "\n";
+        std::cout << "> Cut-offs per stage (TT, good captures, killers, counter move, quiets, bad captures, evasions): ";
+        for (uint64_t cutoffs : stats.stage_cutoffs)
+            std::cout << cutoffs << " ";
+        std::cout << "\n";
     }
 
     return std::make_pair(result, best_move);
-        
+}
+
+void Engine::evaluate(std::span<const Board> boards, std::span<Search::Score> results, unsigned threads) const
+{
+    crawl([&](const auto& crawler) { Evaluation::evaluate(boards, results, crawler.m_nnue, threads); });
+
+    for (std::size_t i = 0; i < boards.size(); i++)
+        results[i] = Evaluation::relative_eval(results[i], boards[i]);
 }
 
 Search::Score Engine::iterative_deepening(Search::Depth depth)
+{
+    return crawl([&](auto& crawler) { return iterative_deepening(crawler, depth); });
+}
+
+template <typename CrawlerT>
+Search::Score Engine::iterative_deepening(CrawlerT& crawler, Search::Depth depth)
 {
     Search::Score result = 0;
 
     for (Search::Depth d = 1; d <= depth; d++)
-        result = m_crawler.search(d);
+        result = crawler.search(d);
 
     return result;
 }
 
 
+// -------------------------
+// Engine - network hot-swap
+// -------------------------
+
+void Engine::load_network(const std::string& filepath)
+{
+    // Network is loaded on a separate thread, and search goes on with the current network in the meantime
+    // - NOTE: if another network is still being loaded, we wait for it first (its result is discarded)
+    m_pending_network = std::async(std::launch::async, [filepath]() {
+        auto start = std::chrono::steady_clock::now();
+
+        std::shared_ptr<Evaluation::NNUE::Weights> weights = std::make_shared<Evaluation::NNUE::Weights>();
+        weights->load(filepath);
+
+        auto end = std::chrono::steady_clock::now();
+
+        return PendingNetwork{ weights, { filepath, std::chrono::duration_cast<std::chrono::microseconds>(end - start) } };
+    });
+}
+
+bool Engine::update_network(bool wait)
+{
+    if (!m_pending_network.valid())
+        return false;
+
+    if (!wait && m_pending_network.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return false;
+
+    // get() rethrows loading errors and invalidates the future, so a failed load is reported only once
+    PendingNetwork pending;
+
+    try {
+        pending = m_pending_network.get();
+    }
+    catch (const std::exception& e) {
+        m_network_error = e.what();
+
+        if (m_mode != Engine::Mode::STANDARD)
+            std::cout << "Network could not be loaded: " << m_network_error << "\n";
+
+        throw;
+    }
+
+    crawl([&](auto& crawler) { crawler.set_network(pending.weights); });
+    m_network = pending.info;
+    m_network_error.clear();
+
+    if (m_mode != Engine::Mode::STANDARD)
+        std::cout << "Network " << m_network.filepath << " loaded in " << m_network.load_time.count() / 1000.0 << " [ms]\n";
+
+    return true;
+}
+
+
 // ---------------------
 // Engine - TEST / DEBUG
 // ---------------------
@@ -82,18 +166,21 @@ void Engine::show_ordering() const
     // Copy ordering from crawler's search
     MoveOrdering::sort(move_selector, [this](const Move& move) -> int32_t {
         if (!move.is_quiet()) {
-            int32_t see = this->m_mem_board.see(move);
-            if (see > 0)    // Prioritize winning captures and promotions
-                return HISTORY_MAX_SCORE + see;
+            int32_t mvv = Evaluation::PieceValues[Search::History::captured_type(this->m_mem_board, move)] + 
+                          Evaluation::PieceValues[move.promotion_type()];
+            int32_t key = CAPTURE_HISTORY_MVV_FACTOR * mvv + this->m_history.score(this->m_mem_board, move);
+
+            // Winning captures and promotions go first, and losing ones go last
+            return this->m_mem_board.see_ge(move, 1) ? HISTORY_MAX_SCORE + key : key - CAPTURE_HISTORY_MVV_FACTOR * HISTORY_MAX_SCORE;
         }
         
         return this->m_history.score(this->m_mem_board, move);
     });
     
     // Show all moves in right order
-    Move move = move_selector.next(MoveOrdering::Selector::STRICT, false);
+    Move move = move_selector.next(MoveOrdering::Selector::STRICT);
     while (move != Moves::null) {
         std::cout << move << std::dec << ", history score: " << m_history.score(m_mem_board, move) << "\n";
-        move = move_selector.next(MoveOrdering::Selector::STRICT, false);
+        move = move_selector.next(MoveOrdering::Selector::STRICT);
     }
 }
\ No newline at end of file
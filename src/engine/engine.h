@@ -2,6 +2,9 @@
 
 #include "search.h"
 #include "ttable.h"
+#include <chrono>
+#include <future>
+#include <variant>
 
 
 /*
@@ -22,18 +25,44 @@ public:
         STATS
     };
 
-    Engine(Mode mode) : m_mode(mode), m_crawler(&m_ttable, &m_history) {}
+    // Network information
+    // - load_time measures the whole loading process (reading, validation and hashing), without waiting for the swap
+    struct NetworkInfo {
+        std::string filepath;
+        std::chrono::microseconds load_time;
+    };
+
+    Engine(Mode mode, const std::string& network = Evaluation::DEFAULT_NETWORK) 
+        : m_mode(mode), m_crawler(make_crawler(mode, &m_ttable, &m_history)) { load_network(network); update_network(true); }
 
     // Setup
-    void set_position(const Board& board) { m_crawler.set_position(board); }
-    void set_position(const std::string& fen) { m_crawler.set_position(fen); }
+    void set_position(const Board& board) { std::visit([&](auto& crawler) { crawler.set_position(board); }, m_crawler); }
+    void set_position(const std::string& fen) { std::visit([&](auto& crawler) { crawler.set_position(fen); }, m_crawler); }
 
     // Main functionalities
     // - Main search function (evaluate) returns both score and best move in current position
     std::pair<Search::Score, Move> evaluate(Search::Depth depth = 0);
     Search::Score iterative_deepening(Search::Depth depth);
 
+    // Batch static evaluation
+    // - Evaluates many independent positions at once with given number of threads, without changing current search position
+    // - Equivalent of calling set_position() and evaluate() with depth 0 for each position, but without quiescence search
+    // - Similarly to evaluate(), results are always relative to white side
+    void evaluate(std::span<const Board> boards, std::span<Search::Score> results, unsigned threads = 1) const;
+
+    // Network hot-swap (EvalFile)
+    // - load_network() starts loading given network file in the background and returns immediately
+    // - update_network() swaps the loaded network in, keeping transposition table and history intact
+    // - Swap happens only between searches - evaluate() calls update_network() before each search
+    // - Returns true if the network has been swapped. With wait = true it blocks until pending load is finished
+    // - If loading fails, the current network stays in use and the error is kept until the next successful swap (see network_error())
+    // - WARNING: update_network() rethrows loading errors, while evaluate() never throws because of them
+    void load_network(const std::string& filepath);
+    bool update_network(bool wait = false);
+
     // Getters
+    const NetworkInfo& network() const { return m_network; }
+    const std::string& network_error() const { return m_network_error; }
     const TranspositionTable* ttable() const { return &m_ttable; }
     const Search::History* history() const { return &m_history; }
     const Board* mem_board() const { return &m_mem_board; }
@@ -43,6 +72,27 @@ public:
     void grid_search();
 
 private:
+    // Search crawlers
+    // - Instrumentation policy of crawler is chosen by engine mode - only STATS mode collects search statistics
+    using Crawlers = std::variant<Search::Crawler<Search::NoStats>, Search::Crawler<Search::SearchStats>>;
+
+    static Crawlers make_crawler(Mode mode, TranspositionTable* ttable, Search::History* history) {
+        if (mode == Mode::STATS)
+            return Crawlers(std::in_place_type<Search::Crawler<Search::SearchStats>>, ttable, history);
+        return Crawlers(std::in_place_type<Search::Crawler<Search::NoStats>>, ttable, history);
+    }
+
+    template <typename F>
+    decltype(auto) crawl(F&& f) { return std::visit(std::forward<F>(f), m_crawler); }
+    template <typename F>
+    decltype(auto) crawl(F&& f) const { return std::visit(std::forward<F>(f), m_crawler); }
+
+    // Main functionalities - implementation for given crawler type
+    template <typename CrawlerT>
+    std::pair<Search::Score, Move> evaluate(CrawlerT& crawler, Search::Depth depth);
+    template <typename CrawlerT>
+    Search::Score iterative_deepening(CrawlerT& crawler, Search::Depth depth);
+
     // Engine mode
     Mode m_mode;
 
@@ -51,8 +101,18 @@ private:
     Search::History m_history;
 
     // Search crawlers
-    Search::Crawler m_crawler;    // For now we use 1 crawler as we use only 1 thread on search
+    Crawlers m_crawler;    // For now we use 1 crawler as we use only 1 thread on search
 
     // Search position snapshot
     Board m_mem_board;
+
+    // Network in use and the one being loaded in the background
+    struct PendingNetwork {
+        std::shared_ptr<const Evaluation::NNUE::Weights> weights;
+        NetworkInfo info;
+    };
+
+    NetworkInfo m_network;
+    std::string m_network_error;
+    std::future<PendingNetwork> m_pending_network;
 };
\ No newline at end of file
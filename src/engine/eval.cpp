@@ -1,5 +1,6 @@
 #include "eval.h"
 #include "evalconfig.h"
+#include "nnue.h"
 
 
 namespace Evaluation {
@@ -8,24 +9,23 @@ namespace Evaluation {
     // Evaluation - main function
     // --------------------------
 
-    Eval evaluate(const Board& board, NNUE& nnue)
+    // Helper function - applying all non-network evaluation factors on top of NNUE output
+    Eval adjust(const Board& board, Eval eval, const MaterialEntry& material)
     {
-        // First, extract main evaluation score from NNUE
-        Eval eval = Eval(nnue.forward(board));
+        // Insufficient material
+        // - Neither side can ever deliver a mate, so the position is a certain draw regardless of network output
+        if (material.insufficient_material)
+            return 0;
 
         // Mating conditions
         // - To improve engine's abilities in finding mates, we apply a simple heuristic for certain mate endgames
-        Color better_side = eval >= 0 ? board.side_to_move() : ~board.side_to_move();
-        Color worse_side = ~better_side;
-
-        // Mate position is simple to detect - worse side must be left with lonely king, and better side must have enough mating material
-        if (Bitboards::singly_populated(board.pieces(worse_side)) &&
-            (board.pieces(better_side, ROOK, QUEEN) || 
-             Bitboards::popcount(board.pieces(better_side, KNIGHT, BISHOP)) >= 2 && board.pieces(better_side, BISHOP) ||
-             Bitboards::popcount(board.pieces(better_side, KNIGHT)) >= 3))
-        {
+        // - Material table already recognized whether one side has enough mating material against a lonely king
+        if (material.endgame_eval == LONE_KING_MATE) {
+            Color better_side = material.strong_side;
+            Color worse_side = ~better_side;
+
             // Interpolate a difference between mating eval and current eval
-            Eval mate_eval = better_side == WHITE ? MAX_EVAL : -MAX_EVAL;
+            Eval mate_eval = better_side == board.side_to_move() ? MAX_EVAL : -MAX_EVAL;
             Eval diff = mate_eval - eval;
 
             // First ingrediant - worse side's king distance to a chessboard corner
@@ -45,4 +45,21 @@ namespace Evaluation {
         return eval;
     }
 
+    Eval evaluate(const Board& board, NNUE& nnue, const MaterialEntry& material)
+    {
+        // First, extract main evaluation score from NNUE
+        Eval eval = Eval(nnue.forward(board));
+
+        return adjust(board, eval, material);
+    }
+
+    void evaluate(std::span<const Board> boards, std::span<Eval> results, const NNUE& nnue, unsigned threads)
+    {
+        // Extract main evaluation scores from NNUE for all positions at once
+        nnue.forward(boards, results, threads);
+
+        for (std::size_t i = 0; i < boards.size(); i++)
+            results[i] = adjust(boards[i], results[i], analyze_material(boards[i].material_key()));
+    }
+
 }
\ No newline at end of file
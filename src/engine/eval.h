@@ -1,7 +1,11 @@
 #pragma once
 
 #include "board.h"
-#include "nnue.h"
+#include <span>
+
+// Forestall declarations
+// - NNUE depends on search limits from searchconfig.h, which in turn includes this file
+namespace Evaluation { class NNUE; }
 
 
 /*
@@ -31,7 +35,14 @@ namespace Evaluation {
     // This function utilizes NNUE to evaluate given position
     // However, value retrieved from NNUE is not the only evaluation factor
     // - Basically an adapter for NNUE, which takes into consideration other things like evaluation descent (approaching 50 move rule)
-    Eval evaluate(const Board& board, NNUE& nnue);
+    // - Material analysis should come from material table, the second version analyzes material from scratch
+    Eval evaluate(const Board& board, NNUE& nnue, const MaterialEntry& material);
+    inline Eval evaluate(const Board& board, NNUE& nnue) { return evaluate(board, nnue, analyze_material(board.material_key())); }
+
+    // Batch version of the above function
+    // - Evaluates many independent positions at once, using NNUE batch forward pass with given number of threads
+    // - Results are relative to side to move in each position, exactly as in single position version
+    void evaluate(std::span<const Board> boards, std::span<Eval> results, const NNUE& nnue, unsigned threads = 1);
 
 
     // -----------------------------
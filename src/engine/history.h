@@ -2,6 +2,8 @@
 
 #include "board.h"
 #include "searchconfig.h"
+#include <atomic>
+#include <span>
 
 /*
     ---------- History ----------
@@ -11,6 +13,10 @@
     - It is named history for tradition, even though it is significantly different than classical history implementation
     - Scores are aggregated in static tables similarly to transposition table entries
     - For each move, the score is calculated using formula: Q(M, n + 1) = Q(M, n) + importance * (R(M) - Q(M, n))
+    - Captures and promotions are scored in a separate capture history table, which additionally distinguishes captured piece type
+    - Quiet moves are additionally scored in continuation history tables, relative to the moves played 1 and 2 plies earlier
+    - Scores and counter moves are read and written with relaxed atomics, so a single table can be shared by many crawlers without data races
+      (an occasional lost update is harmless), alternatively every crawler can own its table and merge them periodically
 */
 
 namespace Search {
@@ -20,6 +26,7 @@ namespace Search {
     // -------
 
     // This class works similarly to transposition table - it is menaged by the engine and shared among all the crawlers
+    // - Global modifiers (reset, flatten, merge) are not thread-safe and should be called only between searches
     class History 
     {
     public:
@@ -27,31 +34,118 @@ namespace Search {
         // - We can look at score as a [0, 1] floating point value quantized into [0, S] integer range for efficiency purposes
         using Score = int16_t;
 
+        // Continuation history entry
+        // - Each entry belongs to a single (piece, to) move and collects scores of quiet moves that followed it
+        // - It also remembers the last quiet move that refuted it (counter move), accessed only through History methods
+        struct Continuation
+        {
+            Score Q[PIECE_RANGE][SQUARE_RANGE] = { 0 };
+            alignas(std::atomic_ref<Move>::required_alignment) Move counter_move = Moves::null;
+        };
+
         // Global modifiers
         // - Allow to reset the whole history table and forget about anything it learned
-        void reset() { for (int i = 0; i < PIECE_RANGE; i++) for (int j = 0; j < SQUARE_RANGE; j++) Q[i][j] = 0; }
-        void flatten(int c = 1) { for (int i = 0; i < PIECE_RANGE; i++) for (int j = 0; j < SQUARE_RANGE; j++) Q[i][j] >>= c;}
+        void reset() { 
+            for (uint32_t i = 0; i < PIECE_RANGE; i++) for (uint32_t j = 0; j < SQUARE_RANGE; j++) Q[i][j] = 0;
+            for (uint32_t i = 0; i < PIECE_RANGE; i++) for (uint32_t j = 0; j < SQUARE_RANGE; j++) for (uint32_t k = 0; k < PIECE_TYPE_RANGE; k++) C[i][j][k] = 0;
+            for (uint32_t i = 0; i < PIECE_RANGE; i++) for (uint32_t j = 0; j < SQUARE_RANGE; j++) CH[i][j] = {};
+        }
+        void flatten(int c = 1) { 
+            for (uint32_t i = 0; i < PIECE_RANGE; i++) for (uint32_t j = 0; j < SQUARE_RANGE; j++) Q[i][j] >>= c;
+            for (uint32_t i = 0; i < PIECE_RANGE; i++) for (uint32_t j = 0; j < SQUARE_RANGE; j++) for (uint32_t k = 0; k < PIECE_TYPE_RANGE; k++) C[i][j][k] >>= c;
+            for (auto& entries : CH) for (auto& entry : entries) for (auto& scores : entry.Q) for (Score& score : scores) score >>= c;
+        }
+        void merge(std::span<const History* const> tables) {
+            // Per-thread tables are merged by summing the scores of all the tables and dividing once, so every table has the same weight
+            // - This table is overwritten, unless it is one of the merged tables
+            // - Counter moves are taken from the first table which has one
+            if (tables.empty())
+                return;
+
+            auto mean = [&tables](auto&& score) -> Score {
+                int32_t sum = 0;
+                for (const History* table : tables)
+                    sum += score(*table);
+                return Score(sum / int32_t(tables.size()));
+            };
+
+            for (uint32_t i = 0; i < PIECE_RANGE; i++) for (uint32_t j = 0; j < SQUARE_RANGE; j++) 
+                Q[i][j] = mean([=](const History& table) { return table.Q[i][j]; });
+            for (uint32_t i = 0; i < PIECE_RANGE; i++) for (uint32_t j = 0; j < SQUARE_RANGE; j++) for (uint32_t k = 0; k < PIECE_TYPE_RANGE; k++) 
+                C[i][j][k] = mean([=](const History& table) { return table.C[i][j][k]; });
+            for (uint32_t i = 0; i < PIECE_RANGE; i++) for (uint32_t j = 0; j < SQUARE_RANGE; j++) {
+                for (uint32_t k = 0; k < PIECE_RANGE; k++) for (uint32_t l = 0; l < SQUARE_RANGE; l++) 
+                    CH[i][j].Q[k][l] = mean([=](const History& table) { return table.CH[i][j].Q[k][l]; });
+
+                Move counter_move = Moves::null;
+                for (const History* table : tables)
+                    if ((counter_move = table->CH[i][j].counter_move) != Moves::null)
+                        break;
+                CH[i][j].counter_move = counter_move;
+            }
+        }
 
         // Local modifiers
         // - Dynamic update of history table
         // - Utilizes Q(M, n + 1) = Q(M, n) + importance * (R(M) - Q(M, n)) formula
         // - importance = (c * depth) / (ply * start_depth) where c is a hyperparameter defined in searchconfig.h
         // - Additional division by 100 to normalize c factor (which is an integer instead of [0, 1] float)
+        // - Captures and promotions update capture history, all the other moves update quiet history
+        // - Counter move of a continuation entry is simply replaced by the latest refutation
         void update(Piece piece, Square to, int c, int8_t start_depth, int8_t depth, int16_t ply, Score R) { 
-            Q[piece][to] = Score(Q[piece][to] + int64_t(c) * depth * (R - Q[piece][to]) / (100 * (ply + 1) * start_depth));
+            learn(Q[piece][to], c, start_depth, depth, ply, R);
+        }
+        void update(Piece piece, Square to, PieceType captured, int c, int8_t start_depth, int8_t depth, int16_t ply, Score R) { 
+            learn(C[piece][to][captured], c, start_depth, depth, ply, R);
+        }
+        void update(Continuation* continuation, Piece piece, Square to, int c, int8_t start_depth, int8_t depth, int16_t ply, Score R) { 
+            learn(continuation->Q[piece][to], c, start_depth, depth, ply, R);
         }
         void update(const Board& board, const Move& move, int c, int8_t start_depth, int8_t depth, int16_t ply, Score R) {
-            update(board.on(move.from()), move.to(), c, start_depth, depth, ply, R);
+            if (move.is_quiet())
+                update(board.on(move.from()), move.to(), c, start_depth, depth, ply, R);
+            else
+                update(board.on(move.from()), move.to(), captured_type(board, move), c, start_depth, depth, ply, R);
         }
+        void update_counter_move(Continuation* continuation, const Move& move) { store(continuation->counter_move, move); }
 
         // Getters
-        Score score(Piece piece, Square to) const { return Q[piece][to]; }
-        Score score (const Board& board, const Move& move) const { return score(board.on(move.from()), move.to()); }
+        Score score(Piece piece, Square to) const { return load(Q[piece][to]); }
+        Score score(Piece piece, Square to, PieceType captured) const { return load(C[piece][to][captured]); }
+        Score score(const Continuation* continuation, Piece piece, Square to) const { return load(continuation->Q[piece][to]); }
+        Move counter_move(const Continuation* continuation) const { return load(continuation->counter_move); }
+        Score score (const Board& board, const Move& move) const { 
+            return move.is_quiet() ? score(board.on(move.from()), move.to()) : 
+                                     score(board.on(move.from()), move.to(), captured_type(board, move)); 
+        }
+
+        // Continuation history access
+        // - Null move (NO_PIECE) has its own entry as well
+        Continuation* continuation(Piece piece, Square to) { return &CH[piece][to]; }
+
+        // Captured piece type of a move (NULL_PIECE_TYPE for non-capturing promotions)
+        // - Must be called before the move is made
+        static PieceType captured_type(const Board& board, const Move& move) {
+            return move.is_enpassant() ? PAWN : type_of(board.on(move.to()));
+        }
 
     private:
         // History tables - move scores
         // - Improved indexing - instead of butterfly index, we use piece-square approach
-        Score Q[PIECE_RANGE][SQUARE_RANGE] = { 0 };        // Move scores
+        Score Q[PIECE_RANGE][SQUARE_RANGE] = { 0 };                         // Quiet move scores
+        Score C[PIECE_RANGE][SQUARE_RANGE][PIECE_TYPE_RANGE] = { 0 };       // Capture scores, indexed additionally by captured piece type
+        Continuation CH[PIECE_RANGE][SQUARE_RANGE] = {};                    // Continuation history, indexed by previous move
+
+        // Helper functions
+        // - Relaxed load & store compile to plain moves, they only make concurrent access well defined
+        template <typename T>
+        static T load(const T& value) { return std::atomic_ref<T>(const_cast<T&>(value)).load(std::memory_order_relaxed); }
+        template <typename T>
+        static void store(T& value, const T& new_value) { std::atomic_ref<T>(value).store(new_value, std::memory_order_relaxed); }
+        static void learn(Score& q, int c, int8_t start_depth, int8_t depth, int16_t ply, Score R) {
+            Score current = load(q);
+            store(q, Score(current + int64_t(c) * depth * (R - current) / (100 * (ply + 1) * start_depth)));
+        }
     };
 
 }
\ No newline at end of file
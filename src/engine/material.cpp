@@ -0,0 +1,49 @@
+#include "material.h"
+#include "evalconfig.h"
+
+
+namespace Evaluation {
+
+    // ---------------------------
+    // Material - analysis results
+    // ---------------------------
+
+    MaterialEntry analyze_material(MaterialKey key)
+    {
+        MaterialEntry entry;
+        entry.key = key;
+
+        auto count = [key](Color side, PieceType type) { return piece_count(key, make_piece(side, type)); };
+
+        // Game stage
+        for (Color side : { WHITE, BLACK })
+            for (PieceType type : { KNIGHT, BISHOP, ROOK, QUEEN })
+                entry.game_stage += count(side, type) * GameStage::PieceWeights[type];
+
+        // Insufficient material
+        // - Only positions where mate is impossible for both sides are considered, so that the draw is certain
+        unsigned pawns = count(WHITE, PAWN) + count(BLACK, PAWN);
+        unsigned majors = count(WHITE, ROOK) + count(BLACK, ROOK) + count(WHITE, QUEEN) + count(BLACK, QUEEN);
+        unsigned minors = count(WHITE, KNIGHT) + count(BLACK, KNIGHT) + count(WHITE, BISHOP) + count(BLACK, BISHOP);
+
+        entry.insufficient_material = pawns == 0 && majors == 0 && minors <= 1;
+
+        // Lone king mates
+        // - Weaker side must be left with lonely king, and stronger side must have enough mating material
+        for (Color side : { WHITE, BLACK }) {
+            bool lone_king = count(~side, PAWN) + count(~side, KNIGHT) + count(~side, BISHOP) +
+                             count(~side, ROOK) + count(~side, QUEEN) == 0;
+            bool mating_material = count(side, ROOK) + count(side, QUEEN) > 0 ||
+                                   (count(side, KNIGHT) + count(side, BISHOP) >= 2 && count(side, BISHOP) > 0) ||
+                                   count(side, KNIGHT) >= 3;
+
+            if (lone_king && mating_material) {
+                entry.endgame_eval = LONE_KING_MATE;
+                entry.strong_side = side;
+            }
+        }
+
+        return entry;
+    }
+
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "types.h"
+#include <algorithm>
+
+
+/*
+    ---------- Material ----------
+
+    Material key and material table
+    - Material key is a packed signature of piece counts, maintained incrementally by the board
+    - Every material-only question (endgame type, draw by insufficient material) is answered once per signature
+      and cached in material table, so evaluation and search need just a single lookup
+    - Material table is not synchronized in any way, so each search thread should own its own table
+*/
+
+namespace Evaluation {
+
+    // --------------------
+    // Material - signature
+    // --------------------
+
+    // Material key stores count of each piece (kings excluded) on 4 bits, with piece value as a nibble index
+    // - Since key is exact (no collisions), all the analysis can be calculated from the key alone
+    // - Adding or removing a piece from the board is a single addition or subtraction
+    using MaterialKey = uint64_t;
+
+    constexpr MaterialKey material_key(Piece piece)
+    {
+        return type_of(piece) == NULL_PIECE_TYPE || type_of(piece) == KING ? 0ULL : 1ULL << (4 * piece);
+    }
+
+    constexpr unsigned piece_count(MaterialKey key, Piece piece)
+    {
+        return unsigned(key >> (4 * piece)) & 0xF;
+    }
+
+
+    // ---------------------------
+    // Material - analysis results
+    // ---------------------------
+
+    // Specialized evaluation functions for recognized endgames
+    enum EndgameEval : uint8_t {
+        NO_ENDGAME_EVAL = 0,
+        LONE_KING_MATE,         // Strong side has enough material to mate a lone king (KX vs K)
+    };
+
+    struct MaterialEntry
+    {
+        MaterialKey key = 0;
+
+        uint16_t game_stage = 0;                // Game stage as defined in evalconfig.h
+        EndgameEval endgame_eval = NO_ENDGAME_EVAL;
+        Color strong_side = WHITE;              // Side which specialized evaluation function favours
+        bool insufficient_material = false;     // Neither side can ever mate (KvK, KNvK, KBvK)
+    };
+
+    // Calculates material analysis from scratch
+    MaterialEntry analyze_material(MaterialKey key);
+
+
+    // ---------------------
+    // Material - hash table
+    // ---------------------
+
+    class MaterialTable
+    {
+    public:
+        MaterialTable() { reset(); }
+
+        // Returns cached analysis for given material key, or analyzes it and replaces the old entry
+        // - Key counts are packed in low nibbles, so key is mixed before indexing to spread similar signatures
+        const MaterialEntry& probe(MaterialKey key) {
+            MaterialEntry& entry = m_entries[(key * 0x9E3779B97F4A7C15ULL) >> (64 - SIZE_LOG)];
+
+            if (entry.key != key)
+                entry = analyze_material(key);
+
+            return entry;
+        }
+
+        // Empty entries must describe the key they hold (0 - bare kings), so they are filled with real analysis
+        void reset() { std::fill(m_entries, m_entries + SIZE, analyze_material(0)); }
+
+        // Number of entries
+        static constexpr uint32_t SIZE_LOG = 13;
+        static constexpr uint32_t SIZE = 1 << SIZE_LOG;
+
+    private:
+        // Main data table
+        MaterialEntry m_entries[SIZE];
+    };
+
+}
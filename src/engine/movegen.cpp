@@ -1,9 +1,38 @@
 #include "movegen.h"
 #include <algorithm>
+#include <cassert>
 
 
 namespace MoveGeneration {
 
+    // -----------------------------------------------
+    // Move generation - collective - legality helpers
+    // -----------------------------------------------
+
+    // Legal generation resolves pins and king safety directly in generators, instead of testing each move with board.is_legal_p()
+    // - Pinned piece can only move along the line connecting it with own king
+    // - King cannot step into a square attacked by enemy piece (king itself is removed from occupancy to see through it)
+    // - Enpassant removes two pieces from the same rank at once, so it needs to be checked for discovered attacks separately
+    inline bool pin_allows(const Board& board, Color side, Square from, Square to)
+    {
+        return !(board.pinned(side) & from) || Chessboard::aligned(board.king_position(side), from, to);
+    }
+
+    inline bool king_safe(const Board& board, Color side, Square to)
+    {
+        return !board.attackers_to(to, ~side, board.pieces() ^ board.king_position(side));
+    }
+
+    inline bool enpassant_safe(const Board& board, Color side, Square from, Square to)
+    {
+        Bitboard occ = (board.pieces() ^ board.enpassant_square() ^ from) | to;
+        Square king = board.king_position(side);
+
+        return !(Pieces::piece_attacks_s<BISHOP>(king, occ) & board.pieces(~side, BISHOP, QUEEN)) &&
+               !(Pieces::piece_attacks_s<ROOK>(king, occ) & board.pieces(~side, ROOK, QUEEN));
+    }
+
+
     // -----------------------------------------
     // Move generation - collective - pawn moves
     // -----------------------------------------
@@ -22,7 +51,7 @@ namespace MoveGeneration {
 		movelist.push_back(Move(from, to, capture ? CAPTURE_FLAG | KNIGHT_PROMOTION_FLAG : KNIGHT_PROMOTION_FLAG));
 	}
 
-    template <Mode mode, Color side, typename MoveT>
+    template <Mode mode, Color side, bool legal, typename MoveT>
     void generate_pawn_moves(const Board& board, Bitboard target, Moves::List<MoveT>& movelist)
     {
         // Compile time properties
@@ -44,6 +73,9 @@ namespace MoveGeneration {
         Bitboard empty_squares = ~board.pieces();
         Bitboard enemy_pieces = board.pieces(enemy);
 
+        // Pinned pawns are rare, so instead of splitting generation we simply verify their moves one by one (legal generation only)
+        Bitboard pinned = legal ? board.pinned(side) & pawns : 0;
+
         // Step 1 - adjust target map with respect to given generation mode
         // - Since CAPTURE mode includes pawn promotions, promotion squares (8th rank for given side) must be included in target set
         // - QUIET mode should not include checks, and QUIET_CHECK should include only checks
@@ -69,10 +101,12 @@ namespace MoveGeneration {
             // Extract single moves from move maps
 			while (single_pushes) {
 				Square to = Bitboards::pop_lsb(single_pushes);
+                if (pinned & (to - forward) && !pin_allows(board, side, to - forward, to)) continue;
 				movelist.push_back(Move(to - forward, to, Moves::QUIET_MOVE_FLAG));
 			}
 			while (double_pushes) {
 				Square to = Bitboards::pop_lsb(double_pushes);
+                if (pinned & (to - forward - forward) && !pin_allows(board, side, to - forward - forward, to)) continue;
 				movelist.push_back(Move(to - forward - forward, to, Moves::DOUBLE_PAWN_PUSH_FLAG));
 			}
 		}
@@ -89,10 +123,12 @@ namespace MoveGeneration {
             // Extract single moves from move maps
 			while (left_captures) {
 				Square to = Bitboards::pop_lsb(left_captures);
+                if (pinned & (to - forward_left) && !pin_allows(board, side, to - forward_left, to)) continue;
 				movelist.push_back(Move(to - forward_left, to, Moves::CAPTURE_FLAG));
 			}
 			while (right_captures) {
 				Square to = Bitboards::pop_lsb(right_captures);
+                if (pinned & (to - forward_right) && !pin_allows(board, side, to - forward_right, to)) continue;
 				movelist.push_back(Move(to - forward_right, to, Moves::CAPTURE_FLAG));
 			}
 
@@ -103,8 +139,11 @@ namespace MoveGeneration {
 				Square to = board.enpassant_square() + forward;
 
                 // Extract single moves from move maps
-				while (enpassant_candidates)
-					movelist.push_back(Move(Bitboards::pop_lsb(enpassant_candidates), to, Moves::ENPASSANT_FLAG));
+				while (enpassant_candidates) {
+                    Square from = Bitboards::pop_lsb(enpassant_candidates);
+                    if (legal && !enpassant_safe(board, side, from, to)) continue;
+					movelist.push_back(Move(from, to, Moves::ENPASSANT_FLAG));
+                }
 			}
         }
 
@@ -119,14 +158,17 @@ namespace MoveGeneration {
             // Extract single moves from move maps
 			while (quiet_promotions) {
 				Square to = Bitboards::pop_lsb(quiet_promotions);
+                if (pinned & (to - forward) && !pin_allows(board, side, to - forward, to)) continue;
 				generate_promotions<false>(to - forward, to, movelist);
 			}
 			while (left_captures) {
 				Square to = Bitboards::pop_lsb(left_captures);
+                if (pinned & (to - forward_left) && !pin_allows(board, side, to - forward_left, to)) continue;
 				generate_promotions<true>(to - forward_left, to, movelist);
 			}
 			while (right_captures) {
 				Square to = Bitboards::pop_lsb(right_captures);
+                if (pinned & (to - forward_right) && !pin_allows(board, side, to - forward_right, to)) continue;
 				generate_promotions<true>(to - forward_right, to, movelist);
 			}
 		}
@@ -137,7 +179,7 @@ namespace MoveGeneration {
     // Move generation - collective - king moves
     // -----------------------------------------
 
-    template <Mode mode, Color side, typename MoveT>
+    template <Mode mode, Color side, bool legal, typename MoveT>
     void generate_king_moves(const Board& board, Bitboard target, Moves::List<MoveT>& movelist)
     {
         // There can be only 1 king of given color on the board, so we can determine from square
@@ -149,6 +191,9 @@ namespace MoveGeneration {
         while (possible_moves) {
             Square to = Bitboards::pop_lsb(possible_moves);
 
+            if (legal && !king_safe(board, side, to))
+                continue;
+
             // Since target might contain both quiet and capture squares (for example - CHECK_EVASION mode), 
             // we must determine which one is quiet and which one is capture
             // - NOTE: there is no need to check whether board.on(to) is friendly piece, because it's already done by applying target map
@@ -157,10 +202,16 @@ namespace MoveGeneration {
 
         // Step 2 - generate castling
         // - Not present in both CAPTURE (since castle is always a quiet move) and CHECK_EVASION (since castle cannot be played when being in check)
+        // - Legal castling additionally requires that king is not in check and does not pass through or land on attacked square
         if constexpr (mode != CAPTURE && mode != CHECK_EVASION) {
-			if (board.can_castle(side, KINGSIDE_CASTLE) && board.castle_path_clear(side, KINGSIDE_CASTLE))
+            if (legal && board.in_check())
+                return;
+
+			if (board.can_castle(side, KINGSIDE_CASTLE) && board.castle_path_clear(side, KINGSIDE_CASTLE) &&
+                (!legal || (king_safe(board, side, from + EAST) && king_safe(board, side, from + EAST + EAST))))
 				movelist.push_back(Move(from, Square(from + EAST + EAST), Moves::KINGSIDE_CASTLE_FLAG));
-			if (board.can_castle(side, QUEENSIDE_CASTLE) && board.castle_path_clear(side, QUEENSIDE_CASTLE))
+			if (board.can_castle(side, QUEENSIDE_CASTLE) && board.castle_path_clear(side, QUEENSIDE_CASTLE) &&
+                (!legal || (king_safe(board, side, from + WEST) && king_safe(board, side, from + WEST + WEST))))
 				movelist.push_back(Move(from, Square(from + WEST + WEST), Moves::QUEENSIDE_CASTLE_FLAG));
         }
     }
@@ -171,11 +222,15 @@ namespace MoveGeneration {
     // ------------------------------------------------
 
     // Knight, bishop, rook and queen moves are easy to generate, since there are no special moves related to those piece types
-    template <Mode mode, Color side, PieceType ptype, typename MoveT>
+    template <Mode mode, Color side, PieceType ptype, bool legal, typename MoveT>
     void generate_piece_moves(const Board& board, Bitboard target, Moves::List<MoveT>& movelist)
     {
         Bitboard pieces = board.pieces(side, ptype);
 
+        // Pinned knights can never move, since knight always leaves the line it stands on (legal generation only)
+        if constexpr (legal && ptype == KNIGHT)
+            pieces &= ~board.pinned(side);
+
         // Step 1 - adjust target map with respect to given generation mode
         // - QUIET mode should not include checks, and QUIET_CHECK should include only checks
         if constexpr (mode == QUIET)
@@ -190,6 +245,12 @@ namespace MoveGeneration {
 
             Bitboard possible_moves = Pieces::piece_attacks_s<ptype>(from, board.pieces()) & target;
 
+            // Pinned sliders can only move along the pin line (legal generation only)
+            if constexpr (legal && ptype != KNIGHT) {
+                if (board.pinned(side) & from)
+                    possible_moves &= Chessboard::Lines[board.king_position(side)][from];
+            }
+
             // Since target might contain both quiet and capture squares (for example - CHECK_EVASION mode), 
             // we must determine which one is quiet and which one is capture
             // - NOTE: there is no need to check whether board.on(to) is friendly piece, because it's already done by applying target map
@@ -206,7 +267,7 @@ namespace MoveGeneration {
     // Move generation - collective - side moves
     // -----------------------------------------
 
-    template <Mode mode, Color side, typename MoveT>
+    template <Mode mode, Color side, bool legal, typename MoveT>
     void generate_side_moves(const Board& board, Moves::List<MoveT>& movelist)
     {
         // Compile time properties
@@ -230,29 +291,29 @@ namespace MoveGeneration {
 
                 // - For non-king pieces, generate only moves that blocks check or captures checking piece (evasion_target)
                 // - For king, generate moves as usual (just without castle)
-                generate_pawn_moves<CHECK_EVASION, side>(board, evasion_target, movelist);
-				generate_piece_moves<CHECK_EVASION, side, KNIGHT>(board, evasion_target, movelist);
-				generate_piece_moves<CHECK_EVASION, side, BISHOP>(board, evasion_target, movelist);
-				generate_piece_moves<CHECK_EVASION, side, ROOK>(board, evasion_target, movelist);
-				generate_piece_moves<CHECK_EVASION, side, QUEEN>(board, evasion_target, movelist);
-				generate_king_moves<CHECK_EVASION, side>(board, target, movelist);
+                generate_pawn_moves<CHECK_EVASION, side, legal>(board, evasion_target, movelist);
+				generate_piece_moves<CHECK_EVASION, side, KNIGHT, legal>(board, evasion_target, movelist);
+				generate_piece_moves<CHECK_EVASION, side, BISHOP, legal>(board, evasion_target, movelist);
+				generate_piece_moves<CHECK_EVASION, side, ROOK, legal>(board, evasion_target, movelist);
+				generate_piece_moves<CHECK_EVASION, side, QUEEN, legal>(board, evasion_target, movelist);
+				generate_king_moves<CHECK_EVASION, side, legal>(board, target, movelist);
             }
             // Double checks
             // - Only king moves can be pseudolegal in double check situations
             else
-                generate_king_moves<CHECK_EVASION, side>(board, target, movelist);
+                generate_king_moves<CHECK_EVASION, side, legal>(board, target, movelist);
         }
         // Step 3 - other modes
         else {
-            generate_pawn_moves<mode, side>(board, target, movelist);
-			generate_piece_moves<mode, side, KNIGHT>(board, target, movelist);
-			generate_piece_moves<mode, side, BISHOP>(board, target, movelist);
-			generate_piece_moves<mode, side, ROOK>(board, target, movelist);
-			generate_piece_moves<mode, side, QUEEN>(board, target, movelist);
+            generate_pawn_moves<mode, side, legal>(board, target, movelist);
+			generate_piece_moves<mode, side, KNIGHT, legal>(board, target, movelist);
+			generate_piece_moves<mode, side, BISHOP, legal>(board, target, movelist);
+			generate_piece_moves<mode, side, ROOK, legal>(board, target, movelist);
+			generate_piece_moves<mode, side, QUEEN, legal>(board, target, movelist);
 
             // King moves can never be checks, so we can omit them in QUIET_CHECK case
 			if constexpr (mode != QUIET_CHECK)
-				generate_king_moves<mode, side>(board, target, movelist);
+				generate_king_moves<mode, side, legal>(board, target, movelist);
         }
     }
 
@@ -267,9 +328,42 @@ namespace MoveGeneration {
     void generate_moves(const Board& board, Moves::List<MoveT>& movelist)
     {
         if (board.side_to_move() == WHITE)
-            generate_side_moves<mode, WHITE>(board, movelist);
+            generate_side_moves<mode, WHITE, false>(board, movelist);
         else
-            generate_side_moves<mode, BLACK>(board, movelist);
+            generate_side_moves<mode, BLACK, false>(board, movelist);
+    }
+
+    // Legal version of the above
+    // - Generates exactly the same moves as generate_moves() followed by board.is_legal_p() filter
+    template <Mode mode, typename MoveT>
+    void generate_legal_moves(const Board& board, Moves::List<MoveT>& movelist)
+    {
+        assert(mode == CHECK_EVASION || !board.in_check());
+
+        if (board.side_to_move() == WHITE)
+            generate_side_moves<mode, WHITE, true>(board, movelist);
+        else
+            generate_side_moves<mode, BLACK, true>(board, movelist);
+    }
+
+    // Specialized version - legal moves generation
+    // - Chooses appropriate legal generation mode depending on whether side to move is in check
+    template <>
+    void generate_moves<LEGAL, Move>(const Board& board, Moves::List<Move>& movelist)
+    {
+        if (board.in_check())
+			generate_legal_moves<CHECK_EVASION>(board, movelist);
+		else
+			generate_legal_moves<PSEUDO_LEGAL>(board, movelist);
+    }
+
+    template <>
+    void generate_moves<LEGAL, EMove>(const Board& board, Moves::List<EMove>& movelist)
+    {
+        if (board.in_check())
+			generate_legal_moves<CHECK_EVASION>(board, movelist);
+		else
+			generate_legal_moves<PSEUDO_LEGAL>(board, movelist);
     }
 
     // Usages declaration
@@ -284,21 +378,16 @@ namespace MoveGeneration {
 	template void generate_moves<CHECK_EVASION, EMove>(const Board&, Moves::List<EMove>&);
 	template void generate_moves<PSEUDO_LEGAL, EMove>(const Board&, Moves::List<EMove>&);
 
-    // Specialized version - legal moves generation
-    // - Legal move generation is basically the same as pseudolegal, with an additional check with board.is_legal_p()
-    // - NOTE: since we basically never use full legal generation in search mechanism, we do not need to implement it's EnhancedMove version
-    template <>
-    void generate_moves<LEGAL, Move>(const Board& board, Moves::List<Move>& movelist)
-    {
-        if (board.in_check())
-			generate_moves<CHECK_EVASION>(board, movelist);
-		else
-			generate_moves<PSEUDO_LEGAL>(board, movelist);
-
-        // Test each move with board.is_legal_p() and put every legal move in front of the list
-        Move* end_of_legals = std::partition(movelist.begin(), movelist.end(), [&board](const Move& move) {return board.is_legal_p(move);});
-		movelist.set_end(end_of_legals);
-    }
+    template void generate_legal_moves<QUIET, Move>(const Board&, Moves::List<Move>&);
+	template void generate_legal_moves<CAPTURE, Move>(const Board&, Moves::List<Move>&);
+	template void generate_legal_moves<QUIET_CHECK, Move>(const Board&, Moves::List<Move>&);
+	template void generate_legal_moves<CHECK_EVASION, Move>(const Board&, Moves::List<Move>&);
+	template void generate_legal_moves<PSEUDO_LEGAL, Move>(const Board&, Moves::List<Move>&);
+    template void generate_legal_moves<QUIET, EMove>(const Board&, Moves::List<EMove>&);
+	template void generate_legal_moves<CAPTURE, EMove>(const Board&, Moves::List<EMove>&);
+	template void generate_legal_moves<QUIET_CHECK, EMove>(const Board&, Moves::List<EMove>&);
+	template void generate_legal_moves<CHECK_EVASION, EMove>(const Board&, Moves::List<EMove>&);
+	template void generate_legal_moves<PSEUDO_LEGAL, EMove>(const Board&, Moves::List<EMove>&);
 
 
     // ----------------------------
@@ -45,6 +45,12 @@ namespace MoveGeneration {
     template <Mode mode, typename MoveT = Move>
 	void generate_moves(const Board& board, Moves::List<MoveT>& movelist);
 
+    // Generate only legal moves of given group (mode)
+    // - Pins, king safety and enpassant discoveries are resolved during generation, so there is no need to call board.is_legal_p() afterwards
+    // - WARNING: when side to move is in check, only CHECK_EVASION mode can be used (other modes would ignore the check)
+    template <Mode mode, typename MoveT = Move>
+	void generate_legal_moves(const Board& board, Moves::List<MoveT>& movelist);
+
 
     // ----------------------------
     // Move generation - individual
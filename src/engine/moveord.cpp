@@ -1,109 +1,9 @@
 #include "moveord.h"
+#include <cassert>
 
 
 namespace MoveOrdering {
 
-    // -------------------------------
-    // Selector - generator operations
-    // -------------------------------
-
-    // Extracting next element
-    EMove Selector::next(Mode mode, bool use_strategy)
-    {
-        while (true) {
-            // Check if current bucket contains more moves
-            if (m_buckets[m_bucket]) {
-                const std::uint32_t index = Bitboards::pop_lsb(m_buckets[m_bucket]);
-                const EMove& move = m_moves[index + m_batch * 64];
-
-                // Check for the case where move is excluded after some selection already being done
-                if (!is_excluded(move)) {
-                    m_last_move_id = index;
-                    return move;
-                }
-                else
-                    continue;
-            }
-            
-            // If no moves are present in a bucket, try to find appropriate move in the remaining portion of current batch
-            // If you encounter moves from any other bucket, save them to speed up future selection
-            while (m_next_move != m_section_end) {
-                EMove& move = *m_next_move;
-
-                // Ignore illegal and excluded moves
-                if (!m_board->is_legal_p(move) || is_excluded(move)) {
-                    m_next_move++;
-                    continue;
-                }
-
-                uint32_t bucketID = use_strategy ? strategy.classify(m_gen, move) : 0;
-                
-                if (bucketID == m_bucket) {
-                    m_last_move_id = uint32_t(std::distance(m_section_begin, m_next_move));
-                    return *m_next_move++;
-                }
-                else
-                    m_buckets[bucketID] |= 0x1ULL << std::distance(m_section_begin, m_next_move++);
-            }
-
-            // If we reach end of the batch without returning appropriate move, then the current bucket is empty and we should move on
-            m_bucket++;
-
-            // If we checked all the buckets, then it's time to change the batch
-            if (m_bucket == MAX_BUCKETS)
-                set_batch(m_batch + 1);
-            
-            // If batch is empty, then there are no more moves to check
-            // Therefore we should either continue with next phase (cascade selection) or break and return null move (strict selection)
-            if (m_section_begin == m_section_end) {
-                m_gen = m_gen == MoveGeneration::CAPTURE ? MoveGeneration::QUIET_CHECK :
-                        m_gen == MoveGeneration::QUIET_CHECK ? MoveGeneration::QUIET : MoveGeneration::NONE;
-
-                if (mode != STRICT && m_gen != MoveGeneration::NONE)
-                    generate_moves();
-                
-                if (mode != FULL_CASCADE || m_gen == MoveGeneration::NONE)
-                    break;
-            }
-        }
-
-        return Moves::null;
-    }
-
-    // Checking whether next element can still be extracted
-    // - Uses next() with revert of any changes
-    // - WARNING: caution recommended when combining this with any sorting
-    bool Selector::has_next()
-    {
-        EMove move = next(FULL_CASCADE, true);
-
-        if (move == Moves::null)
-            return false;
-
-        restore_last();
-
-        return true;
-    }
-
-
-    // -------------------
-    // Selector - strategy
-    // -------------------
-
-    uint32_t Selector::Strategy::classify(MoveGeneration::Mode mode, EMove& move) const
-    {
-        uint32_t bucket = 0;
-
-        for (const Predicate& pred : decisionLists[mode]) {
-            if (pred(move))
-                break;
-            bucket++;
-        }
-
-        return bucket;
-    }
-
-
     // ------------------------------------------------
     // Selector - helper functions - move pool handling
     // ------------------------------------------------
@@ -113,22 +13,23 @@ namespace MoveOrdering {
         // Start by clearing move list (generators use push_back)
         m_moves.clear();
 
-        // NOTE: Since selector always checks legality, there is no point in handling LEGAL generation mode
+        // Selector uses legal generators, so each generated move is ready to be played
+        // - NOTE: for this reason, there is no point in handling LEGAL generation mode separately
         switch (m_gen) {
             case MoveGeneration::QUIET:
-                MoveGeneration::generate_moves<MoveGeneration::QUIET, EMove>(*m_board, m_moves);
+                MoveGeneration::generate_legal_moves<MoveGeneration::QUIET, EMove>(*m_board, m_moves);
                 break;
             case MoveGeneration::QUIET_CHECK:
-                MoveGeneration::generate_moves<MoveGeneration::QUIET_CHECK, EMove>(*m_board, m_moves);
+                MoveGeneration::generate_legal_moves<MoveGeneration::QUIET_CHECK, EMove>(*m_board, m_moves);
                 break;
             case MoveGeneration::CAPTURE:
-                MoveGeneration::generate_moves<MoveGeneration::CAPTURE, EMove>(*m_board, m_moves);
+                MoveGeneration::generate_legal_moves<MoveGeneration::CAPTURE, EMove>(*m_board, m_moves);
                 break;
             case MoveGeneration::CHECK_EVASION:
-                MoveGeneration::generate_moves<MoveGeneration::CHECK_EVASION, EMove>(*m_board, m_moves);
+                MoveGeneration::generate_legal_moves<MoveGeneration::CHECK_EVASION, EMove>(*m_board, m_moves);
                 break;
             default:
-                MoveGeneration::generate_moves<MoveGeneration::PSEUDO_LEGAL, EMove>(*m_board, m_moves);
+                MoveGeneration::generate_legal_moves<MoveGeneration::PSEUDO_LEGAL, EMove>(*m_board, m_moves);
                 break;
         }
 
@@ -149,4 +50,140 @@ namespace MoveOrdering {
         std::fill(m_buckets, m_buckets + MAX_BUCKETS, 0);
     }
 
-}
\ No newline at end of file
+    bool Selector::next_phase(Mode mode)
+    {
+        // Strict selection stays in the exhausted phase, so that a later cascade starts from the next phase with its moves generated
+        if (mode == STRICT)
+            return false;
+
+        m_gen = m_gen == MoveGeneration::CAPTURE ? MoveGeneration::QUIET_CHECK :
+                m_gen == MoveGeneration::QUIET_CHECK ? MoveGeneration::QUIET : MoveGeneration::NONE;
+
+        if (m_gen != MoveGeneration::NONE)
+            generate_moves();
+
+        return mode == FULL_CASCADE && m_gen != MoveGeneration::NONE;
+    }
+
+
+    // ------------------------
+    // Staged selector - set up
+    // ------------------------
+
+    StagedSelector::StagedSelector(const Board* board, const Move& tt_move, std::span<const Move> killers, const Move& counter_move)
+        : m_board(board), m_tt_move(tt_move), m_counter_move(counter_move)
+    {
+        assert(m_tt_move == Moves::null || m_board->is_legal_f(m_tt_move));
+
+        for (std::size_t i = 0; i < std::min<std::size_t>(killers.size(), MAX_KILLERS); i++)
+            m_killers.push_back(killers[i]);
+
+        // Transposition table move should never be returned twice
+        if (m_tt_move != Moves::null)
+            m_excluded.push_back(m_tt_move);
+    }
+
+
+    // -------------------------------------------
+    // Staged selector - helper functions - stages
+    // -------------------------------------------
+
+    void StagedSelector::generate_captures()
+    {
+        m_moves.clear();
+        MoveGeneration::generate_legal_moves<MoveGeneration::CAPTURE, EMove>(*m_board, m_moves);
+
+        // Captures are divided into good and bad ones by SEE sign
+        // - Only the sign is needed, so threshold test is used instead of full SEE
+        // - Order inside of each group is decided later by the indexer
+        for (EMove& move : m_moves)
+            move.mark_see(m_board->see_ge(move, 1));
+
+        m_bad_captures_begin = std::partition(m_moves.begin(), m_moves.end(), [](const EMove& move) -> bool { return move.see_positive().value(); });
+        m_bad_captures_end = m_moves.end();
+        m_next_move = m_moves.begin();
+        m_picks = 0;
+    }
+
+    EMove* StagedSelector::generate_quiets()
+    {
+        // Quiet moves are appended after captures
+        // - Quiet checks together with the rest of quiet moves cover all quiet moves
+        EMove* begin = m_moves.end();
+
+        MoveGeneration::generate_legal_moves<MoveGeneration::QUIET_CHECK, EMove>(*m_board, m_moves);
+        MoveGeneration::generate_legal_moves<MoveGeneration::QUIET, EMove>(*m_board, m_moves);
+
+        m_next_move = begin;
+
+        return begin;
+    }
+
+    void StagedSelector::generate_evasions()
+    {
+        m_moves.clear();
+        MoveGeneration::generate_legal_moves<MoveGeneration::CHECK_EVASION, EMove>(*m_board, m_moves);
+
+        m_bad_captures_begin = m_bad_captures_end = m_moves.end();
+        m_next_move = m_moves.begin();
+        m_picks = 0;
+    }
+
+    EMove StagedSelector::select_killer()
+    {
+        while (m_next_killer < m_killers.size()) {
+            const Move& killer = m_killers[m_next_killer++];
+
+            if (is_refutation(killer)) {
+                m_excluded.push_back(killer);
+                return killer;
+            }
+        }
+
+        return Moves::null;
+    }
+
+    bool StagedSelector::is_refutation(const Move& move) const
+    {
+        // Only quiet moves and bad captures are considered, since good captures were already returned
+        // - Killers and counter moves come from other nodes, so they also require a full legality check
+        return move != Moves::null && !is_excluded(move) && 
+               (move.is_quiet() || !m_board->see_ge(move, 1)) && m_board->is_legal_f(move);
+    }
+
+    EMove StagedSelector::select(EMove* end)
+    {
+        while (m_next_move != end) {
+            const EMove& move = *m_next_move++;
+
+            if (!is_excluded(move))
+                return move;
+        }
+
+        return Moves::null;
+    }
+
+    EMove StagedSelector::pick(EMove* end)
+    {
+        // Lazy selection sort - the best of remaining moves is swapped to the front of the range
+        // - Usually only a few moves are tried before a cut-off, so most of the groups are never fully ordered
+        // - If a group turns out to be searched further, the rest of it is sorted at once to avoid quadratic cost
+        while (m_next_move != end) {
+            if (m_picks < MAX_LAZY_PICKS)
+                std::swap(*std::max_element(m_next_move, end, [](const EMove& a, const EMove& b) -> bool { return a.key() < b.key(); }), 
+                          *m_next_move);
+            else if (m_picks == MAX_LAZY_PICKS)
+                std::sort(m_next_move, end, [](const EMove& a, const EMove& b) -> bool { return a.key() > b.key(); });
+
+            m_picks++;
+
+            const EMove& move = *m_next_move++;
+
+            if (!is_excluded(move))
+                return move;
+        }
+
+        return Moves::null;
+    }
+
+}
@@ -3,7 +3,9 @@
 #include "movegen.h"
 #include "../utilities/sarray.h"
 #include <algorithm>
-#include <functional>
+#include <concepts>
+#include <span>
+#include <tuple>
 
 
 /*
@@ -11,6 +13,7 @@
 
     Tools for ordering and selection of moves
     - Implements both discreet (buckets) and continuous (standard sort) ordering of moves
+    - Ordering rules (strategies & indexers) are compile-time parameters, so that they can be fully inlined in search routines
 */
 
 namespace MoveOrdering {
@@ -25,15 +28,97 @@ namespace MoveOrdering {
     // Maximum number of excluded moves in Selector class
     constexpr uint8_t MAX_EXCLUDED_MOVES = 4;
 
+    // Maximum number of killer moves in StagedSelector class
+    constexpr uint8_t MAX_KILLERS = 4;
+
+    // Number of moves picked lazily from each group in StagedSelector class, before the rest of the group is sorted
+    constexpr uint8_t MAX_LAZY_PICKS = 4;
+
+
+    // ------------------------------------------
+    // Move ordering - discrete - ordering rules
+    // ------------------------------------------
+
+    // Indexer definition
+    // - Indexer is a function that transforms a move into some integer, which then allows to compare different moves during sort
+    // - NOTE: polymorphism allows this one to work for both Move and EMove objects
+    template <typename F>
+    concept Indexer = std::invocable<const F&, const Move&> && std::convertible_to<std::invoke_result_t<const F&, const Move&>, int32_t>;
+
+    // Predicate definition
+    // - Predicate decides whether given move belongs to a bucket
+    template <typename F>
+    concept Predicate = std::invocable<const F&, EMove&> && std::convertible_to<std::invoke_result_t<const F&, EMove&>, bool>;
+
+    // Selection strategy rule
+    // - A predicate applied only to moves from given generation phase
+    template <MoveGeneration::Mode mode, Predicate Pred>
+    struct Rule
+    {
+        static constexpr MoveGeneration::Mode phase = mode;
+
+        Pred pred;
+    };
+
+    template <MoveGeneration::Mode mode, Predicate Pred>
+    constexpr Rule<mode, Pred> make_rule(Pred pred) { return Rule<mode, Pred>{ pred }; }
+
+    // Selection strategy
+    // - Selection strategy is the main part of discrete move ordering
+    // - Works as a compact decision tree which decides which bucket is appropriate for given move
+    // - Composed at compile time from a list of rules - rules of given phase are checked in order, and the first one
+    //   which accepts the move decides the bucket (moves not accepted by any rule go to the last bucket)
+    // - Empty strategy puts all the moves into the first bucket
+    template <typename... Rules>
+    class Strategy
+    {
+    public:
+        constexpr Strategy(Rules... rules) : m_rules(rules...) {}
+
+        // Assigns move to appropriate bucket based on defined rules
+        uint32_t classify(MoveGeneration::Mode mode, EMove& move) const {
+            uint32_t bucket = 0;
+            bool found = false;
+
+            std::apply([&](const auto&... rule) {
+                ((found = found || (rule.phase == mode && (rule.pred(move) || (bucket++, false)))), ...);
+            }, m_rules);
+
+            return bucket;
+        }
+
+    private:
+        // Each phase can have at most MAX_BUCKETS - 1 rules
+        static constexpr bool valid() {
+            for (uint32_t mode = 0; mode < MoveGeneration::MODE_RANGE; mode++)
+                if (((Rules::phase == mode) + ... + 0) > MAX_BUCKETS - 1)
+                    return false;
+            return true;
+        }
+
+        static_assert(valid(), "Too many strategy rules for a single generation phase");
+
+        // Representation of linearized decision tree
+        std::tuple<Rules...> m_rules;
+    };
+
 
     // -----------------------------------
     // Move ordering - discrete - selector
     // -----------------------------------
 
+    // Forestall declarations
+    // - Selector can be sorted with continuous ordering, which requires access to selector's internals
+    class Selector;
+
+    template <Indexer IndexerT>
+    void sort(Selector& selector, const IndexerT& indexer, Moves::Enhancement enhancement_type = Moves::Enhancement::CUSTOM_SORTING);
+
     // Ordering & selection of moves
     // - Permament connection with given board
     // - Generator-style interface
-    // - Implements discret ordering by dividing moves into buckets based on given conditions forming a mini decision tree
+    // - Implements discret ordering by dividing moves into buckets based on given strategy forming a mini decision tree
+    // - Strategy is passed with every generator operation, so it must stay the same for the whole selection
     class Selector
     {
     public:
@@ -41,14 +126,16 @@ namespace MoveOrdering {
             : m_board(board), m_gen(gen) { generate_moves(); }
 
         // Selector behavior - generation phase switch strategy
-        // - STRICT: Select moves only from current generation phase
+        // - STRICT: Select moves only from current generation phase (phase is not changed after it runs out of moves)
         // - PARTIAL_CASCADE: Similar to STRICT, but changes the generation phase after first null move return (it works once per phase)
         // - FULL_CASCADE: Always changes generation phase and continues selection if there are no more moves from current phase
         enum Mode : uint32_t { STRICT = 0, PARTIAL_CASCADE, FULL_CASCADE };
 
         // Generator operations
-        EMove next(Mode mode = FULL_CASCADE, bool use_strategy = true);
-        bool has_next();
+        template <typename StrategyT = Strategy<>>
+        EMove next(Mode mode = FULL_CASCADE, const StrategyT& strategy = StrategyT());
+        template <typename StrategyT = Strategy<>>
+        bool has_next(const StrategyT& strategy = StrategyT());
 
         // Restoring last generated move
         // - Uses bucket ordering idea to save element back to the currently explored bucket and quickly recover it
@@ -59,45 +146,20 @@ namespace MoveOrdering {
         void include_all() { m_excluded.clear(); }
         bool is_excluded(const Move& move) const { return std::find(m_excluded.begin(), m_excluded.end(), move) != m_excluded.end(); }
 
-        // Selection strategy
-        // - Selection strategy is the main part of discrete move ordering
-        // - Works as a compact decision tree which decides which bucket is appropriate for given move
-        // - Can be created in dynamic way by adding or removing comparators
-        // - Publicly available outside Selector class
-        class Strategy
-        {
-        public:
-            Strategy() = default;
-
-            // Type definitions
-            using Predicate = std::function<bool(EMove&)>;
-
-            // Dynamic rules
-            void add_rule(MoveGeneration::Mode mode, Predicate pred) { decisionLists[mode].push_back(pred); }
-            void clear_rules(MoveGeneration::Mode mode) { decisionLists[mode].clear(); }
-            void clear_rules() { for (auto& list : decisionLists) list.clear(); }
-
-            // Assigns move to appropriate bucket based on defined rules
-            uint32_t classify(MoveGeneration::Mode mode, EMove& move) const;
-
-        private:
-            // Representation of linearized decision tree for each phase
-            StableArray<Predicate, MAX_BUCKETS - 1> decisionLists[MoveGeneration::MODE_RANGE];
-
-        } strategy;
-
         // Other getters
         std::size_t size() const { return m_moves.size(); }
         MoveGeneration::Mode phase() const { return m_gen; }
 
         // Friends
-        friend void sort(Selector& selector, const std::function<int32_t(const Move& move)>& indexer, Moves::Enhancement enhancement_type);
+        template <Indexer IndexerT>
+        friend void sort(Selector& selector, const IndexerT& indexer, Moves::Enhancement enhancement_type);
 
     private:
         // Helper functions - move pool handlers
         void generate_moves();              // Generates moves according to m_gen mode
         void set_batch(uint8_t batch_id);
         void reset_batch() { set_batch(0); }
+        bool next_phase(Mode mode);         // Switches to next generation phase, returns false if selection should stop
 
         // Board connection
         const Board* m_board;
@@ -128,28 +190,284 @@ namespace MoveOrdering {
     };
 
 
+    // -------------------------------
+    // Selector - generator operations
+    // -------------------------------
+
+    // Extracting next element
+    template <typename StrategyT>
+    EMove Selector::next(Mode mode, const StrategyT& strategy)
+    {
+        while (true) {
+            // Check if current bucket contains more moves
+            if (m_buckets[m_bucket]) {
+                const std::uint32_t index = Bitboards::pop_lsb(m_buckets[m_bucket]);
+                const EMove& move = m_moves[index + m_batch * 64];
+
+                // Check for the case where move is excluded after some selection already being done
+                if (!is_excluded(move)) {
+                    m_last_move_id = index;
+                    return move;
+                }
+                else
+                    continue;
+            }
+            
+            // If no moves are present in a bucket, try to find appropriate move in the remaining portion of current batch
+            // If you encounter moves from any other bucket, save them to speed up future selection
+            while (m_next_move != m_section_end) {
+                EMove& move = *m_next_move;
+
+                // Ignore excluded moves
+                // - NOTE: there is no need to check legality, since selector generates only legal moves
+                if (is_excluded(move)) {
+                    m_next_move++;
+                    continue;
+                }
+
+                uint32_t bucketID = strategy.classify(m_gen, move);
+                
+                if (bucketID == m_bucket) {
+                    m_last_move_id = uint32_t(std::distance(m_section_begin, m_next_move));
+                    return *m_next_move++;
+                }
+                else
+                    m_buckets[bucketID] |= 0x1ULL << std::distance(m_section_begin, m_next_move++);
+            }
+
+            // If we reach end of the batch without returning appropriate move, then the current bucket is empty and we should move on
+            m_bucket++;
+
+            // If we checked all the buckets, then it's time to change the batch
+            if (m_bucket == MAX_BUCKETS)
+                set_batch(m_batch + 1);
+            
+            // If batch is empty, then there are no more moves to check
+            // Therefore we should either continue with next phase (cascade selection) or break and return null move (strict selection)
+            if (m_section_begin == m_section_end && !next_phase(mode))
+                break;
+        }
+
+        return Moves::null;
+    }
+
+    // Checking whether next element can still be extracted
+    // - Uses next() with revert of any changes
+    // - WARNING: caution recommended when combining this with any sorting
+    template <typename StrategyT>
+    bool Selector::has_next(const StrategyT& strategy)
+    {
+        EMove move = next(FULL_CASCADE, strategy);
+
+        if (move == Moves::null)
+            return false;
+
+        restore_last();
+
+        return true;
+    }
+
+
+    // ------------------------------------------
+    // Move ordering - discrete - staged selector
+    // ------------------------------------------
+
+    // Staged selection of moves for the main search
+    // - Moves are generated lazily, one group at a time, so that nodes which cut off early do not pay for generating all the moves
+    // - Stages follow the expected move quality: transposition table move, good captures (SEE > 0), killers, counter move,
+    //   quiet moves and finally bad captures (SEE <= 0)
+    // - When side to move is in check, all evasions are generated at once (EVASIONS stage), right after transposition table move
+    // - Captures are split into good and bad ones by SEE, and every group of moves is then ordered by indexer given to next()
+    // - Captures and evasions are scored once and the best ones are picked lazily, since they usually produce a cut-off early
+    // - Quiet moves are sorted at once, since most of the nodes that reach them end up searching all of them
+    class StagedSelector
+    {
+    public:
+        // Stages in order of selection
+        // - NOTE: stages from GOOD_CAPTURES to BAD_CAPTURES are skipped when in check, and EVASIONS stage otherwise
+        enum Stage : uint32_t { TT_MOVE = 0, GOOD_CAPTURES, KILLERS, COUNTER_MOVE, QUIETS, BAD_CAPTURES, EVASIONS, STAGE_RANGE };
+
+        // Killers and counter move are validated before being returned, so any moves can be passed here
+        // - WARNING: transposition table move must be already validated by the caller (null or legal), since it is returned as is
+        StagedSelector(const Board* board, const Move& tt_move, std::span<const Move> killers, const Move& counter_move = Moves::null);
+
+        // Generator operations
+        // - Returns null move when there are no more moves
+        // - Indexer must stay the same for the whole selection
+        template <Indexer IndexerT>
+        EMove next(const IndexerT& indexer);
+
+        // Excluding moves
+        // - Transposition table move, returned killers and returned counter move are excluded automatically
+        void exclude(const Move& move) { m_excluded.push_back(move); }
+        bool is_excluded(const Move& move) const { return std::find(m_excluded.begin(), m_excluded.end(), move) != m_excluded.end(); }
+
+        // Getters
+        // - stage() returns the stage of the last returned move
+        Stage stage() const { return m_stage; }
+
+    private:
+        // Helper functions - stage handlers
+        void generate_captures();
+        EMove* generate_quiets();       // Returns the beginning of generated quiet moves
+        void generate_evasions();
+        EMove select_killer();          // Returns next valid killer, or null move if there are no more killers
+        bool is_refutation(const Move& move) const;     // Checks if killer or counter move can be returned at current position
+        EMove select(EMove* end);       // Returns next not excluded move from [m_next_move, end) range
+        EMove pick(EMove* end);         // Returns the best not excluded move from [m_next_move, end) range
+
+        // Helper functions - ordering
+        template <Indexer IndexerT>
+        void score_moves(EMove* begin, EMove* end, const IndexerT& indexer);
+        template <Indexer IndexerT>
+        void order(EMove* begin, EMove* end, const IndexerT& indexer);
+
+        // Board connection
+        const Board* m_board;
+
+        // Moves known before generation
+        Move m_tt_move;
+        bool m_tt_move_tried = false;
+        StableArray<Move, MAX_KILLERS> m_killers;
+        uint32_t m_next_killer = 0;
+        Move m_counter_move;
+
+        // Current stage
+        Stage m_stage = TT_MOVE;
+
+        // Move handling logic
+        // - Captures are generated first, and quiet moves are appended after them, so that bad captures are kept for the last stage
+        // - Layout: | good captures | bad captures | quiet moves |
+        Moves::List<EMove> m_moves;
+        EMove* m_next_move = nullptr;
+        uint32_t m_picks = 0;           // Number of moves picked lazily from current group
+        EMove* m_bad_captures_begin = nullptr;
+        EMove* m_bad_captures_end = nullptr;
+
+        // Exclusion list
+        StableArray<Move, MAX_EXCLUDED_MOVES + MAX_KILLERS + 2> m_excluded;
+    };
+
+
+    // ---------------------------------------
+    // Staged selector - generator operations
+    // ---------------------------------------
+
+    template <Indexer IndexerT>
+    EMove StagedSelector::next(const IndexerT& indexer)
+    {
+        while (true) {
+            switch (m_stage) {
+                // Stage 1 - transposition table move
+                // - Returned before generating anything, which saves the whole generation when it produces a cut-off
+                // - Search validates it once when probing transposition table, so it is not checked again here
+                case TT_MOVE:
+                    if (!m_tt_move_tried) {
+                        m_tt_move_tried = true;
+
+                        if (m_tt_move != Moves::null)
+                            return m_tt_move;
+                    }
+
+                    if (m_board->in_check()) {
+                        generate_evasions();
+                        score_moves(m_moves.begin(), m_moves.end(), indexer);
+                        m_stage = EVASIONS;
+                    }
+                    else {
+                        generate_captures();
+                        score_moves(m_moves.begin(), m_bad_captures_begin, indexer);
+                        score_moves(m_bad_captures_begin, m_bad_captures_end, indexer);
+                        m_stage = GOOD_CAPTURES;
+                    }
+                    break;
+
+                // Stage 2 - good captures (SEE > 0)
+                case GOOD_CAPTURES:
+                    if (EMove move = pick(m_bad_captures_begin); move != Moves::null)
+                        return move;
+
+                    m_stage = KILLERS;
+                    break;
+
+                // Stage 3 - killers
+                case KILLERS:
+                    if (EMove move = select_killer(); move != Moves::null)
+                        return move;
+
+                    m_stage = COUNTER_MOVE;
+                    if (is_refutation(m_counter_move)) {
+                        m_excluded.push_back(m_counter_move);
+                        return m_counter_move;
+                    }
+                    break;
+
+                // Stage 4 - counter move
+                // - Returned at most once, right after entering the stage (see above)
+                case COUNTER_MOVE:
+                    order(generate_quiets(), m_moves.end(), indexer);
+                    m_stage = QUIETS;
+                    break;
+
+                // Stage 5 - quiet moves
+                case QUIETS:
+                    if (EMove move = select(m_moves.end()); move != Moves::null)
+                        return move;
+
+                    m_next_move = m_bad_captures_begin;
+                    m_picks = 0;
+                    m_stage = BAD_CAPTURES;
+                    break;
+
+                // Stage 6 - bad captures (SEE <= 0)
+                case BAD_CAPTURES:
+                    return pick(m_bad_captures_end);
+
+                // Stage 2 (in check) - all evasions
+                case EVASIONS:
+                    return pick(m_moves.end());
+
+                default:
+                    return Moves::null;
+            }
+        }
+    }
+
+    // Scores moves from [begin, end) range with given indexer
+    // - Moves are not sorted here, pick() selects the best of them one at a time
+    template <Indexer IndexerT>
+    void StagedSelector::score_moves(EMove* begin, EMove* end, const IndexerT& indexer)
+    {
+        for (EMove* move = begin; move != end; move++)
+            move->enhance(Moves::Enhancement::CUSTOM_SORTING, indexer(*move));
+    }
+
+    // Orders moves from [begin, end) range with given indexer
+    template <Indexer IndexerT>
+    void StagedSelector::order(EMove* begin, EMove* end, const IndexerT& indexer)
+    {
+        score_moves(begin, end, indexer);
+        std::sort(begin, end, [](const EMove& a, const EMove& b) -> bool { return a.key() > b.key(); });
+    }
+
+
     // ---------------------------------
     // Move ordering - continuous - sort
     // ---------------------------------
 
     // NOTE: all of the below sortings are in descending order
 
-    // Indexer definition
-    // - Indexer is a function that transforms a move into some integer, which then allows to compare different moves during sort
-    // - NOTE: polymorphism allows this one to work for both Move and EMove objects
-    using Indexer = std::function<int32_t(const Move& move)>;
-
     // Standard sort - for plain move list
     // - Not in place
     // - Less efficient, not recommended to use inside search routine
-    template <unsigned size = 256>
-    void sort(Moves::List<Move, size>& moves, const Indexer& indexer)
+    template <unsigned size = 256, Indexer IndexerT>
+    void sort(Moves::List<Move, size>& moves, const IndexerT& indexer)
     {
         // An external table is necessary in this case
         std::pair<Move, int32_t> rtable[size];
 
         std::transform(moves.begin(), moves.end(), rtable, 
-                       [](const Move& move) -> std::pair<Move, int32_t> { return std::make_pair(move, indexer(move)); });
+                       [&indexer](const Move& move) -> std::pair<Move, int32_t> { return std::make_pair(move, indexer(move)); });
         std::sort(rtable, rtable + moves.size(), 
                   [](const auto& a, const auto& b) -> bool { return a.second > b.second; });
         std::transform(rtable, rtable + moves.size(), moves.begin(),
@@ -159,8 +477,8 @@ namespace MoveOrdering {
     // Standard sort - for enhanced move list
     // - In place, since we can store indices directly inside move objects
     // - Allows to choose the enhancement and therefore reuse the calculated keys in the future (see EMove specialized getters)
-    template <unsigned size = 256>
-    void sort(Moves::List<EMove, size>& moves, const Indexer& indexer, 
+    template <unsigned size = 256, Indexer IndexerT>
+    void sort(Moves::List<EMove, size>& moves, const IndexerT& indexer, 
               Moves::Enhancement enhancement_type = Moves::Enhancement::CUSTOM_SORTING)
     {
         // First calculate indices and then sort
@@ -172,8 +490,8 @@ namespace MoveOrdering {
 
     // Standard sort - for move selector
     // - Since move selector is essentially an enhanced move list with dynamic range, we can treat it almost the same as above
-    inline void sort(Selector& selector, const Indexer& indexer,
-                     Moves::Enhancement enhancement_type = Moves::Enhancement::CUSTOM_SORTING)
+    template <Indexer IndexerT>
+    void sort(Selector& selector, const IndexerT& indexer, Moves::Enhancement enhancement_type)
     {
         selector.set_batch(uint8_t(selector.m_batch));
 
@@ -162,11 +162,20 @@ namespace Moves {
         std::optional<int32_t> score() const { return m_enhancement == Enhancement::PURE_SEARCH_SCORE ?
                                                                        std::make_optional(m_key) : std::nullopt; }
 
+        // SEE sign
+        // - Stored independently of the enhancement, so it survives re-keying of the move by sorting or search score
+        // - Once SEE is known for a move, it never has to be computed again
+        void mark_see(bool positive) { m_see_sign = positive ? 1 : -1; }
+        std::optional<bool> see_positive() const { return m_see_sign ? std::make_optional(m_see_sign > 0) : std::nullopt; }
+
     private:
         Enhancement m_enhancement = Enhancement::NONE;      // Enchancement type
+        int8_t m_see_sign = 0;                              // SEE sign (0 if unknown), fits into padding before the key
         int32_t m_key = 0;                                  // Enchancement value
     };
 
+    static_assert(sizeof(EnhancedMove) == 8, "SEE sign must not increase the size of enhanced move");
+
     // Useful type alias for shorten name
     using EMove = EnhancedMove;
 
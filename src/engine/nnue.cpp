@@ -1,55 +1,265 @@
 #include "nnue.h"
+#include <cmath>
 #include <exception>
 #include <fstream>
+#include <thread>
+#include <vector>
 
 
 namespace Evaluation {
 
+    // ---------------------
+    // NNUE - file integrity
+    // ---------------------
+
+    // Helper function - FNV-1a hash of given bytes, continuing from previous hash value
+    // - Simple and fast enough to verify over 1.5 MB of parameters on every load
+    constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+    constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+    uint64_t hash_bytes(uint64_t hash, const void* data, std::size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+        for (std::size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+
+        return hash;
+    }
+
+    template <uint32_t AccumulatorSize>
+    std::size_t NetworkWeights<AccumulatorSize>::parameters_size(Quantization file_quantization)
+    {
+        std::size_t weight_size = file_quantization == Quantization::INT8 ? sizeof(int8_t) : sizeof(int16_t);
+
+        return INPUT_SIZE * AccumulatorSize * weight_size + sizeof(accumulator_biases) + 
+               sizeof(output_weights) + sizeof(output_bias);
+    }
+
+    template <uint32_t AccumulatorSize>
+    uint64_t NetworkWeights<AccumulatorSize>::parameters_hash() const
+    {
+        uint64_t hash = FNV_OFFSET_BASIS;
+
+        if (quantization == Quantization::INT8)
+            hash = hash_bytes(hash, accumulator_weights_int8->values, sizeof(accumulator_weights_int8->values));
+        else
+            hash = hash_bytes(hash, accumulator_weights->values, sizeof(accumulator_weights->values));
+        hash = hash_bytes(hash, accumulator_biases, sizeof(accumulator_biases));
+
+        for (uint32_t i = 0; i < OUTPUT_BUCKETS; i++) {
+            hash = hash_bytes(hash, output_weights[i], sizeof(output_weights[i]));
+            hash = hash_bytes(hash, &output_bias[i], sizeof(output_bias[i]));
+        }
+
+        return hash;
+    }
+
+
     // -------------------------
     // NNUE - loading parameters
     // -------------------------
 
-    void NNUE::load(const std::string& filepath)
+    template <uint32_t AccumulatorSize>
+    void NetworkWeights<AccumulatorSize>::load(const std::string& filepath)
     {
         // Open binary input file
-        std::ifstream file(filepath, std::ios::binary);
+        std::ifstream file(filepath, std::ios::binary | std::ios::ate);
 
         if (!file.is_open())
             throw std::invalid_argument("ERROR: Cannot open file " + filepath);
 
+        std::size_t file_size = std::size_t(file.tellg());
+        file.seekg(0);
+
+        // Read and validate the header
+        // - Old files without the header are recognized by their exact size (they are always INT16 and have no hash)
+        NetworkHeader header = {};
+        bool legacy = file_size == parameters_size(Quantization::INT16);
+
+        if (!legacy) {
+            file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+            if (!file || !std::equal(header.magic, header.magic + sizeof(header.magic), NETWORK_MAGIC))
+                throw std::invalid_argument("ERROR: " + filepath + " is not a network file");
+            if (header.version != NETWORK_VERSION)
+                throw std::invalid_argument("ERROR: Unsupported network version " + std::to_string(header.version) + " in " + filepath);
+            if (header.input_size != INPUT_SIZE || header.accumulator_size != AccumulatorSize || header.output_buckets != OUTPUT_BUCKETS)
+                throw std::invalid_argument("ERROR: Network architecture " + std::to_string(header.input_size) + "->" + 
+                                            std::to_string(header.accumulator_size) + "x2->" + std::to_string(header.output_buckets) + 
+                                            " in " + filepath + " does not match expected " + std::to_string(INPUT_SIZE) + "->" + 
+                                            std::to_string(AccumulatorSize) + "x2->" + std::to_string(OUTPUT_BUCKETS));
+            if (header.qa != QA || header.qb != QB)
+                throw std::invalid_argument("ERROR: Unsupported quantization factors in " + filepath);
+            if (header.quantization > uint32_t(Quantization::INT8))
+                throw std::invalid_argument("ERROR: Unknown quantization type in " + filepath);
+            if (file_size != sizeof(header) + parameters_size(Quantization(header.quantization)))
+                throw std::invalid_argument("ERROR: Network file " + filepath + " is truncated or has unexpected size");
+        }
+
+        quantization = legacy ? Quantization::INT16 : Quantization(header.quantization);
+
+        // Keep feature transformer weights of loaded quantization only
+        if (quantization == Quantization::INT8) {
+            if (!accumulator_weights_int8) accumulator_weights_int8 = std::make_unique<FeatureWeights<int8_t>>();
+            accumulator_weights.reset();
+        }
+        else {
+            if (!accumulator_weights) accumulator_weights = std::make_unique<FeatureWeights<int16_t>>();
+            accumulator_weights_int8.reset();
+        }
+
         // Read network parameters
         // - Very important to read in correct order (weights before biases, full layer before another)
-        file.read(reinterpret_cast<char*>(m_accumulator_weights), sizeof(m_accumulator_weights));
-        file.read(reinterpret_cast<char*>(m_accumulator_biases), sizeof(m_accumulator_biases));
+        if (quantization == Quantization::INT8)
+            file.read(reinterpret_cast<char*>(accumulator_weights_int8->values), sizeof(accumulator_weights_int8->values));
+        else
+            file.read(reinterpret_cast<char*>(accumulator_weights->values), sizeof(accumulator_weights->values));
+        file.read(reinterpret_cast<char*>(accumulator_biases), sizeof(accumulator_biases));
 
         // Now for every output bucket
         // - weights nr 1 -> bias nr 1 -> weights nr 2 -> bias nr 2 -> ...
-        for (int i = 0; i < OUTPUT_BUCKETS; i++) {
-            file.read(reinterpret_cast<char*>(m_output_weights[i]), sizeof(m_output_weights[i]));
-            file.read(reinterpret_cast<char*>(&m_output_bias[i]), sizeof(m_output_bias[i]));
+        for (uint32_t i = 0; i < OUTPUT_BUCKETS; i++) {
+            file.read(reinterpret_cast<char*>(output_weights[i]), sizeof(output_weights[i]));
+            file.read(reinterpret_cast<char*>(&output_bias[i]), sizeof(output_bias[i]));
         }
 
+        if (!file)
+            throw std::invalid_argument("ERROR: Cannot read network parameters from " + filepath);
+
+        // Finally, make sure parameters were not corrupted
+        if (!legacy && parameters_hash() != header.hash)
+            throw std::invalid_argument("ERROR: Network file " + filepath + " is corrupted (hash mismatch)");
+
         // Close file stream
         file.close();
     }
 
+    template <uint32_t AccumulatorSize>
+    void NetworkWeights<AccumulatorSize>::save(const std::string& filepath, Quantization file_quantization) const
+    {
+        // Open binary output file
+        std::ofstream file(filepath, std::ios::binary);
+
+        if (!file.is_open())
+            throw std::invalid_argument("ERROR: Cannot open file " + filepath);
+
+        // Convert feature transformer weights into requested quantization
+        // - Conversion from INT16 to INT8 rounds each weight to the lower precision, clamping the few outliers to 8-bit range
+        // - Conversion from INT8 to INT16 is lossless
+        std::vector<int8_t> weights_int8;
+        std::vector<int16_t> weights_int16;
+
+        if (file_quantization == Quantization::INT8) {
+            weights_int8.resize(INPUT_SIZE * AccumulatorSize);
+
+            for (uint32_t i = 0; i < INPUT_SIZE; i++) {
+                for (uint32_t j = 0; j < AccumulatorSize; j++) {
+                    weights_int8[i * AccumulatorSize + j] = quantization == Quantization::INT8 ? accumulator_weights_int8->values[i][j] :
+                        int8_t(std::clamp<long>(std::lround(float(accumulator_weights->values[i][j]) / (1 << QA_INT8_SHIFT)), -127, 127));
+                }
+            }
+        }
+        else {
+            weights_int16.resize(INPUT_SIZE * AccumulatorSize);
+
+            for (uint32_t i = 0; i < INPUT_SIZE; i++) {
+                for (uint32_t j = 0; j < AccumulatorSize; j++) {
+                    weights_int16[i * AccumulatorSize + j] = quantization == Quantization::INT16 ? accumulator_weights->values[i][j] :
+                                                                                                     accumulator_weights_int8->values[i][j] << QA_INT8_SHIFT;
+                }
+            }
+        }
+
+        const char* weights = file_quantization == Quantization::INT8 ? reinterpret_cast<const char*>(weights_int8.data()) :
+                                                                   reinterpret_cast<const char*>(weights_int16.data());
+        std::size_t weights_size = weights_int8.size() * sizeof(int8_t) + weights_int16.size() * sizeof(int16_t);
+
+        // Fill in the header
+        // - Hash must be calculated in exactly the same order as parameters are written
+        NetworkHeader header = {};
+        std::copy(NETWORK_MAGIC, NETWORK_MAGIC + sizeof(NETWORK_MAGIC), header.magic);
+        header.version = NETWORK_VERSION;
+        header.input_size = INPUT_SIZE;
+        header.accumulator_size = AccumulatorSize;
+        header.output_buckets = OUTPUT_BUCKETS;
+        header.qa = QA;
+        header.qb = QB;
+        header.quantization = uint32_t(file_quantization);
+
+        header.hash = hash_bytes(FNV_OFFSET_BASIS, weights, weights_size);
+        header.hash = hash_bytes(header.hash, accumulator_biases, sizeof(accumulator_biases));
+
+        for (uint32_t i = 0; i < OUTPUT_BUCKETS; i++) {
+            header.hash = hash_bytes(header.hash, output_weights[i], sizeof(output_weights[i]));
+            header.hash = hash_bytes(header.hash, &output_bias[i], sizeof(output_bias[i]));
+        }
+
+        // Write header and network parameters
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(weights, weights_size);
+        file.write(reinterpret_cast<const char*>(accumulator_biases), sizeof(accumulator_biases));
+
+        for (uint32_t i = 0; i < OUTPUT_BUCKETS; i++) {
+            file.write(reinterpret_cast<const char*>(output_weights[i]), sizeof(output_weights[i]));
+            file.write(reinterpret_cast<const char*>(&output_bias[i]), sizeof(output_bias[i]));
+        }
+
+        // Close file stream
+        file.close();
+    }
+
+
+    template <uint32_t AccumulatorSize>
+    void Network<AccumulatorSize>::load(const std::string& filepath)
+    {
+        // Load parameters into a separate object first, so that network stays usable if loading fails
+        std::shared_ptr<Weights> weights = std::make_shared<Weights>();
+        weights->load(filepath);
+
+        m_weights = std::move(weights);
+    }
+
 
     // -------------------------------
     // NNUE - network updates - static
     // -------------------------------
 
-    void NNUE::set(const Board& board)
+    template <uint32_t AccumulatorSize>
+    void Network<AccumulatorSize>::set(const Board& board)
     {
         // Reset state pointers
         m_curr_ply = 0;
         m_last_ready_ply = 0;
 
-        // Iterate over all accumulator's neurons
-        for (int n_id = 0; n_id < ACCUMULATOR_SIZE; n_id++) {
-            // Reset accumulator value for both accumulators
-            // - We can already set value to the corresponding bias to save two additional operations
-            m_acc_white[m_curr_ply].values[n_id] = m_accumulator_biases[n_id];
-            m_acc_black[m_curr_ply].values[n_id] = m_accumulator_biases[n_id];
+        refresh(board, m_accumulators[m_curr_ply]);
+
+        // Now each of accumulator's values are correctly calculated and network is ready to perform quick forward pass (and obtain eval score)
+    }
+
+
+    // Helper function - calculating accumulators of both perspectives from scratch
+    // - Uses AVX2 intrinsics and iterates over pieces in the outer loop, so that each weight row is read sequentially
+    template <uint32_t AccumulatorSize>
+    void Network<AccumulatorSize>::refresh(const Board& board, Accumulator accumulators[COLOR_RANGE]) const
+    {
+        if (m_weights->quantization == Quantization::INT8)
+            refresh(board, accumulators, m_weights->accumulator_weights_int8->values);
+        else
+            refresh(board, accumulators, m_weights->accumulator_weights->values);
+    }
+
+    template <uint32_t AccumulatorSize>
+    template <typename WeightT>
+    void Network<AccumulatorSize>::refresh(const Board& board, Accumulator accumulators[COLOR_RANGE], const WeightT weights[][AccumulatorSize]) const
+    {
+        for (Color perspective : {WHITE, BLACK}) {
+            int16_t* values = accumulators[perspective].values;
+
+            // We can already set values to the corresponding biases
+            std::copy(m_weights->accumulator_biases, m_weights->accumulator_biases + AccumulatorSize, values);
 
             // Iterate over all pieces
             // - This approach is a little bit faster than iterating over all possible squares
@@ -57,20 +267,20 @@ namespace Evaluation {
 
             while (pieces) {
                 Square sq = Bitboards::pop_lsb(pieces);
-                Color side = color_of(board.on(sq));
-                PieceType ptype = type_of(board.on(sq));
+                Index index = {color_of(board.on(sq)), type_of(board.on(sq)), sq};
+
+                // NOTE: input values are 0/1, which means dot product simplifies into sum of corresponding weights
+                const WeightT* row = weights[index(perspective)];
 
-                Index index = {side, ptype, sq};
+                // Since 256-bit chunk of data contains 256 / 16 = 16 16-bit integers, we can increase loop step to 16
+                for (uint32_t i = 0; i < AccumulatorSize; i += 16) {
+                    __m256i vals = _mm256_load_si256(reinterpret_cast<const __m256i*>(&values[i]));
+                    __m256i add_vals = load_weights(&row[i]);
 
-                // Update both accumulators
-                // - NOTE: input values are 0/1, which means dot product simplifies into sum of corresponding weights
-                // - NOTE: it's important to match accumulator with correct perspective (acc_white = WHITE perspective, acc_black = BLACK perspective)
-                m_acc_white[m_curr_ply].values[n_id] += m_accumulator_weights[index(WHITE)][n_id];
-                m_acc_black[m_curr_ply].values[n_id] += m_accumulator_weights[index(BLACK)][n_id];
+                    _mm256_store_si256(reinterpret_cast<__m256i*>(&values[i]), _mm256_add_epi16(vals, add_vals));
+                }
             }
         }
-
-        // Now each of accumulator's values are correctly calculated and network is ready to perform quick forward pass (and obtain eval score)
     }
 
 
@@ -78,8 +288,12 @@ namespace Evaluation {
     // NNUE - network updates - dynamic
     // --------------------------------
 
-    void NNUE::update(const Board& board, const Move& move)
+    template <uint32_t AccumulatorSize>
+    void Network<AccumulatorSize>::update(const Board& board, const Move& move)
     {
+        // Accumulator stack is sized to the maximum search depth, so it should never overflow
+        assert(m_curr_ply + 1 < int(MAX_PLY));
+
         // Step 1 - get rid of all entries in updates stack
         updates[m_curr_ply].clear();
 
@@ -120,33 +334,38 @@ namespace Evaluation {
 
     // Helper function - making updates and prepering accumulators for a forward pass
     // - This function is called only when forward pass needs to be made
-    void NNUE::make_updates()
+    template <uint32_t AccumulatorSize>
+    void Network<AccumulatorSize>::make_updates()
+    {
+        if (m_weights->quantization == Quantization::INT8)
+            make_updates(m_weights->accumulator_weights_int8->values);
+        else
+            make_updates(m_weights->accumulator_weights->values);
+    }
+
+    template <uint32_t AccumulatorSize>
+    template <typename WeightT>
+    void Network<AccumulatorSize>::make_updates(const WeightT weights[][AccumulatorSize])
     {
         // We want to incrementally update each accumulator up until the one pointed by ply pointer
         while (m_last_ready_ply < m_curr_ply) {
+            const auto& changes = updates[m_last_ready_ply];
+            Accumulator* prev = m_accumulators[m_last_ready_ply];
+            Accumulator* next = m_accumulators[m_last_ready_ply + 1];
+
             // Select update function by checking size of the corresponding updates list
             // - NOTE: two updates always corresponds to add_sub, three updates always corresponds to add_sub_sub, and similarly with four updates
-            if (updates[m_last_ready_ply].size() == 2) {
-                m_acc_white[m_last_ready_ply + 1].add_sub(&m_acc_white[m_last_ready_ply], m_accumulator_weights,
-                                                          updates[m_last_ready_ply][0](WHITE), updates[m_last_ready_ply][1](WHITE));
-                m_acc_black[m_last_ready_ply + 1].add_sub(&m_acc_black[m_last_ready_ply], m_accumulator_weights,
-                                                          updates[m_last_ready_ply][0](BLACK), updates[m_last_ready_ply][1](BLACK));
-            }
-            else if (updates[m_last_ready_ply].size() == 3) {
-                m_acc_white[m_last_ready_ply + 1].add_sub_sub(&m_acc_white[m_last_ready_ply], m_accumulator_weights,
-                                                              updates[m_last_ready_ply][0](WHITE), updates[m_last_ready_ply][1](WHITE),
-                                                              updates[m_last_ready_ply][2](WHITE));
-                m_acc_black[m_last_ready_ply + 1].add_sub_sub(&m_acc_black[m_last_ready_ply], m_accumulator_weights,
-                                                              updates[m_last_ready_ply][0](BLACK), updates[m_last_ready_ply][1](BLACK),
-                                                              updates[m_last_ready_ply][2](BLACK));
-            }
-            else {
-                m_acc_white[m_last_ready_ply + 1].add_add_sub_sub(&m_acc_white[m_last_ready_ply], m_accumulator_weights,
-                                                                  updates[m_last_ready_ply][0](WHITE), updates[m_last_ready_ply][1](WHITE),
-                                                                  updates[m_last_ready_ply][2](WHITE), updates[m_last_ready_ply][3](WHITE));
-                m_acc_black[m_last_ready_ply + 1].add_add_sub_sub(&m_acc_black[m_last_ready_ply], m_accumulator_weights,
-                                                                  updates[m_last_ready_ply][0](BLACK), updates[m_last_ready_ply][1](BLACK),
-                                                                  updates[m_last_ready_ply][2](BLACK), updates[m_last_ready_ply][3](BLACK));
+            for (Color perspective : {WHITE, BLACK}) {
+                if (changes.size() == 2)
+                    next[perspective].add_sub(&prev[perspective], weights,
+                                              changes[0](perspective), changes[1](perspective));
+                else if (changes.size() == 3)
+                    next[perspective].add_sub_sub(&prev[perspective], weights,
+                                                  changes[0](perspective), changes[1](perspective), changes[2](perspective));
+                else
+                    next[perspective].add_add_sub_sub(&prev[perspective], weights,
+                                                      changes[0](perspective), changes[1](perspective),
+                                                      changes[2](perspective), changes[3](perspective));
             }
 
             // Mark processed ply as ready by incrementing the pointer
@@ -156,15 +375,17 @@ namespace Evaluation {
 
     // Accumulator update functions - for quiet moves
     // - Uses AVX and AVX2 intrinsics to vectorize calculations
-    void NNUE::Accumulator::add_sub(NNUE::Accumulator* prev, int16_t weights[][ACCUMULATOR_SIZE], 
+    template <uint32_t AccumulatorSize>
+    template <typename WeightT>
+    void Network<AccumulatorSize>::Accumulator::add_sub(const Accumulator* prev, const WeightT weights[][AccumulatorSize], 
                                     uint32_t add_idx, uint32_t sub_idx)
     {
         // Since 256-bit chunk of data contains 256 / 16 = 16 16-bit integers, we can increase loop step to 16
-        for (int i = 0; i < ACCUMULATOR_SIZE; i += 16) {
+        for (uint32_t i = 0; i < AccumulatorSize; i += 16) {
             // Load chunks of data
             __m256i prev_vals = _mm256_load_si256(reinterpret_cast<const __m256i*>(&prev->values[i]));
-            __m256i add_vals = _mm256_load_si256(reinterpret_cast<const __m256i*>(&weights[add_idx][i]));
-            __m256i sub_vals = _mm256_load_si256(reinterpret_cast<const __m256i*>(&weights[sub_idx][i]));
+            __m256i add_vals = load_weights(&weights[add_idx][i]);
+            __m256i sub_vals = load_weights(&weights[sub_idx][i]);
 
             // Perform arithmetic operations
             // - in this case one addition and one subtraction, since we are in add_sub function
@@ -177,16 +398,18 @@ namespace Evaluation {
     }
 
     // Accumulator update functions - for captures
-    void NNUE::Accumulator::add_sub_sub(NNUE::Accumulator* prev, int16_t weights[][ACCUMULATOR_SIZE],
+    template <uint32_t AccumulatorSize>
+    template <typename WeightT>
+    void Network<AccumulatorSize>::Accumulator::add_sub_sub(const Accumulator* prev, const WeightT weights[][AccumulatorSize],
                                         uint32_t add_idx, uint32_t sub_idx_1, uint32_t sub_idx_2)
     {
         // Since 256-bit chunk of data contains 256 / 16 = 16 16-bit integers, we can increase loop step to 16
-        for (int i = 0; i < ACCUMULATOR_SIZE; i += 16) {
+        for (uint32_t i = 0; i < AccumulatorSize; i += 16) {
             // Load chunks of data
             __m256i prev_vals = _mm256_load_si256(reinterpret_cast<const __m256i*>(&prev->values[i]));
-            __m256i add_vals = _mm256_load_si256(reinterpret_cast<const __m256i*>(&weights[add_idx][i]));
-            __m256i sub1_vals = _mm256_load_si256(reinterpret_cast<const __m256i*>(&weights[sub_idx_1][i]));
-            __m256i sub2_vals = _mm256_load_si256(reinterpret_cast<const __m256i*>(&weights[sub_idx_2][i]));
+            __m256i add_vals = load_weights(&weights[add_idx][i]);
+            __m256i sub1_vals = load_weights(&weights[sub_idx_1][i]);
+            __m256i sub2_vals = load_weights(&weights[sub_idx_2][i]);
 
             // Perform arithmetic operations
             // - in this case one addition and two subtractions, since we are in add_sub_sub function
@@ -200,17 +423,19 @@ namespace Evaluation {
     }
 
     // Accumulator update functions - for castles
-    void NNUE::Accumulator::add_add_sub_sub(NNUE::Accumulator* prev, int16_t weights[][ACCUMULATOR_SIZE],
+    template <uint32_t AccumulatorSize>
+    template <typename WeightT>
+    void Network<AccumulatorSize>::Accumulator::add_add_sub_sub(const Accumulator* prev, const WeightT weights[][AccumulatorSize],
                                             uint32_t add_idx_1, uint32_t add_idx_2, uint32_t sub_idx_1, uint32_t sub_idx_2)
     {
         // Since 256-bit chunk of data contains 256 / 16 = 16 16-bit integers, we can increase loop step to 16
-        for (int i = 0; i < ACCUMULATOR_SIZE; i += 16) {
+        for (uint32_t i = 0; i < AccumulatorSize; i += 16) {
             // Load chunks of data
             __m256i prev_vals = _mm256_load_si256(reinterpret_cast<const __m256i*>(&prev->values[i]));
-            __m256i add1_vals = _mm256_load_si256(reinterpret_cast<const __m256i*>(&weights[add_idx_1][i]));
-            __m256i add2_vals = _mm256_load_si256(reinterpret_cast<const __m256i*>(&weights[add_idx_2][i]));
-            __m256i sub1_vals = _mm256_load_si256(reinterpret_cast<const __m256i*>(&weights[sub_idx_1][i]));
-            __m256i sub2_vals = _mm256_load_si256(reinterpret_cast<const __m256i*>(&weights[sub_idx_2][i]));
+            __m256i add1_vals = load_weights(&weights[add_idx_1][i]);
+            __m256i add2_vals = load_weights(&weights[add_idx_2][i]);
+            __m256i sub1_vals = load_weights(&weights[sub_idx_1][i]);
+            __m256i sub2_vals = load_weights(&weights[sub_idx_2][i]);
 
             // Perform arithmetic operations
             // - in this case two addition and two subtractions, since we are in add_add_sub_sub function
@@ -229,34 +454,42 @@ namespace Evaluation {
     // NNUE - forward pass
     // -------------------
 
-    int32_t NNUE::forward(const Board& board)
+    template <uint32_t AccumulatorSize>
+    int32_t Network<AccumulatorSize>::forward(const Board& board)
     {
-        __m256i v_eval = _mm256_setzero_si256();
-
-        // Step 1 - make sure accumulators are properly updated and network is ready to calculate outputs
+        // Make sure accumulators are properly updated and network is ready to calculate outputs
         make_updates();
 
-        // Step 2 - order accumulators based on current side to move
-        Accumulator* stm_acc = board.side_to_move() == WHITE ? &m_acc_white[m_curr_ply] : &m_acc_black[m_curr_ply];
-        Accumulator* nstm_acc = board.side_to_move() == WHITE ? &m_acc_black[m_curr_ply] : &m_acc_white[m_curr_ply];
+        return output(board, m_accumulators[m_curr_ply]);
+    }
+
+    // Helper function - output layer calculation
+    template <uint32_t AccumulatorSize>
+    int32_t Network<AccumulatorSize>::output(const Board& board, const Accumulator accumulators[COLOR_RANGE]) const
+    {
+        __m256i v_eval = _mm256_setzero_si256();
 
-        // Step 3 - select appropriate output bucket based on number of non-king pieces on the board
+        // Step 1 - order accumulators based on current side to move
+        const Accumulator* stm_acc = &accumulators[board.side_to_move()];
+        const Accumulator* nstm_acc = &accumulators[~board.side_to_move()];
+
+        // Step 2 - select appropriate output bucket based on number of non-king pieces on the board
         constexpr uint32_t divisor = (32 + OUTPUT_BUCKETS - 1) / OUTPUT_BUCKETS;
         uint32_t no_pieces = Bitboards::popcount(board.pieces()) - 2;
         uint32_t bucket_id = no_pieces / divisor;
 
-        int16_t* output_weights = m_output_weights[bucket_id];
-        int16_t output_bias = m_output_bias[bucket_id];
+        const int16_t* output_weights = m_weights->output_weights[bucket_id];
+        int16_t output_bias = m_weights->output_bias[bucket_id];
 
-        // Step 4 - calculate dor product for output layer
+        // Step 3 - calculate dor product for output layer
         // - Vectorized calculations, 8 values at once
-        for (int i = 0; i < ACCUMULATOR_SIZE; i += 8) {
+        for (uint32_t i = 0; i < AccumulatorSize; i += 8) {
             __m128i stm_vals = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&stm_acc->values[i]));
             __m128i nstm_vals = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&nstm_acc->values[i]));
 
             // Side to move related accumulator always goes first
             __m128i stm_weights = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&output_weights[i]));
-            __m128i nstm_weights = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&output_weights[ACCUMULATOR_SIZE + i]));
+            __m128i nstm_weights = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&output_weights[AccumulatorSize + i]));
 
             __m256i stm_activations = activation(stm_vals);
             __m256i nstm_activations = activation(nstm_vals);
@@ -273,7 +506,7 @@ namespace Evaluation {
             v_eval = _mm256_add_epi32(v_eval, result2);
         }
 
-        // Step 5 - restore scalar evaluation from eval vector
+        // Step 4 - restore scalar evaluation from eval vector
         // - Since eval vector contains of 8 evaluation score parts, we must concatenate them back into one integer value
         int32_t tmp[8];
         _mm256_storeu_si256(reinterpret_cast<__m256i*>(tmp), v_eval);
@@ -285,7 +518,7 @@ namespace Evaluation {
         // Don't forget about bias
         eval += output_bias;
 
-        // Step 6 - dequantization
+        // Step 5 - dequantization
         // - Because of quantization, eval is initially scalled by (QA * QB)
         // - WARNING: Be careful for implicit casts! (eval /= (QA * QB) produces critical errors when eval < 0 due to implicit casts)
         eval /= static_cast<int32_t>(QA * QB);
@@ -293,4 +526,69 @@ namespace Evaluation {
         return eval;
     }
 
-}
\ No newline at end of file
+
+    // -------------------------
+    // NNUE - batch forward pass
+    // -------------------------
+
+    template <uint32_t AccumulatorSize>
+    void Network<AccumulatorSize>::forward(std::span<const Board> boards, std::span<int32_t> results, unsigned threads) const
+    {
+        // There is no point in creating threads that would have less than one chunk of positions to process
+        std::size_t no_chunks = (boards.size() + BATCH_CHUNK_SIZE - 1) / BATCH_CHUNK_SIZE;
+        threads = unsigned(std::clamp<std::size_t>(threads, 1, std::max<std::size_t>(no_chunks, 1)));
+
+        // Each thread gets a contiguous range of positions (rounded to full chunks)
+        // - The calling thread processes the first range by itself
+        std::size_t range = (no_chunks + threads - 1) / threads * BATCH_CHUNK_SIZE;
+        std::vector<std::thread> workers;
+
+        for (unsigned t = 1; t < threads; t++) {
+            std::size_t begin = std::min(t * range, boards.size());
+            std::size_t size = std::min(range, boards.size() - begin);
+
+            workers.emplace_back(&Network::forward_range, this, boards.subspan(begin, size), results.subspan(begin, size));
+        }
+
+        forward_range(boards.first(std::min(range, boards.size())), results);
+
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    // Helper function - batch forward pass for a single range of positions
+    template <uint32_t AccumulatorSize>
+    void Network<AccumulatorSize>::forward_range(std::span<const Board> boards, std::span<int32_t> results) const
+    {
+        // Accumulators for a single chunk of positions
+        // - Kept separately from accumulator stack, which allows to use the same network from different threads
+        alignas(32) Accumulator accumulators[BATCH_CHUNK_SIZE][COLOR_RANGE];
+
+        for (std::size_t begin = 0; begin < boards.size(); begin += BATCH_CHUNK_SIZE) {
+            std::size_t size = std::min<std::size_t>(BATCH_CHUNK_SIZE, boards.size() - begin);
+
+            // Step 1 - build accumulators for all positions in the chunk
+            for (std::size_t i = 0; i < size; i++)
+                refresh(boards[begin + i], accumulators[i]);
+
+            // Step 2 - apply output layer for all positions in the chunk
+            // - Output weights stay in cache for the whole chunk
+            for (std::size_t i = 0; i < size; i++)
+                results[begin + i] = output(boards[begin + i], accumulators[i]);
+        }
+    }
+
+
+    // ------------------------------
+    // NNUE - supported network sizes
+    // ------------------------------
+
+    template struct NetworkWeights<256>;
+    template struct NetworkWeights<512>;
+    template struct NetworkWeights<1024>;
+
+    template class Network<256>;
+    template class Network<512>;
+    template class Network<1024>;
+
+}
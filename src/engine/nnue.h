@@ -1,8 +1,12 @@
 #pragma once
 
 #include "board.h"
+#include "searchconfig.h"
 #include "../utilities/sarray.h"
+#include <cassert>
 #include <immintrin.h>
+#include <memory>
+#include <span>
 
 
 /*
@@ -20,17 +24,72 @@ namespace Evaluation {
     // -----------------
 
     // These parameters depend on used architecture and should be matched carefully with loaded network
+    // - Accumulator size is not fixed, since smaller networks trade some strength for speed (see Network)
+    // - ACCUMULATOR_SIZE is the size of the network used by the engine, and can be changed at build time
     constexpr uint32_t INPUT_SIZE = 768;
-    constexpr uint32_t ACCUMULATOR_SIZE = 1024;
     constexpr uint32_t OUTPUT_BUCKETS = 8;
     constexpr uint32_t OUTPUT_SIZE = 1;
 
+#ifdef NNUE_ACCUMULATOR_SIZE
+    constexpr uint32_t ACCUMULATOR_SIZE = NNUE_ACCUMULATOR_SIZE;
+#else
+    constexpr uint32_t ACCUMULATOR_SIZE = 1024;
+#endif
+
+    static_assert(ACCUMULATOR_SIZE == 256 || ACCUMULATOR_SIZE == 512 || ACCUMULATOR_SIZE == 1024, 
+                  "Supported accumulator sizes are 256, 512 and 1024");
+
     // Quantization factors
     constexpr uint32_t QA = 100;
     constexpr uint32_t QB = 100;
 
-    // Other parameters
-    constexpr uint32_t MAX_PLY = 50 + 1;
+    // Quantization types
+    // - INT16: all weights are stored as 16-bit integers quantized with QA (feature transformer) and QB (output layer)
+    // - INT8: feature transformer weights are stored as 8-bit integers quantized with QA >> QA_INT8_SHIFT, which halves
+    //         the amount of memory read with each accumulator update. Output layer and biases are the same as in INT16
+    enum class Quantization : uint8_t { INT16 = 0, INT8 };
+
+    constexpr uint32_t QA_INT8_SHIFT = 4;
+
+    // Default network file
+    const std::string DEFAULT_NETWORK = "model/model_best.nnue";
+
+    // Batch evaluation - number of positions processed together
+    // - Accumulators for the whole chunk are built first, and only then the output layer is applied to all of them
+    constexpr uint32_t BATCH_CHUNK_SIZE = 32;
+
+    // Accumulator stack size
+    // - Crawler can go down up to MAX_TOTAL_SEARCH_DEPTH plies (main search + quiescence), and each ply needs its own accumulators
+    // - An additional entry is reserved for the root position
+    constexpr uint32_t MAX_PLY = MAX_TOTAL_SEARCH_DEPTH + 1;
+
+
+    // ------------------
+    // NNUE - file format
+    // ------------------
+
+    // Every network file starts with a header describing the architecture, followed by network parameters
+    // - Parameters are stored in the following order: feature transformer weights, feature transformer biases,
+    //   and then output weights and output bias of each bucket (weights nr 1 -> bias nr 1 -> weights nr 2 -> ...)
+    // - Hash is calculated over all the parameters (FNV-1a), which allows to detect corrupted files
+    // - NOTE: old network files contain only INT16 parameters without the header. They are still accepted, but only if file size matches exactly
+    struct NetworkHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t input_size;
+        uint32_t accumulator_size;
+        uint32_t output_buckets;
+        uint32_t qa;
+        uint32_t qb;
+        uint32_t quantization;
+        uint64_t hash;
+    };
+
+    static_assert(sizeof(NetworkHeader) == 40, "Network header must not contain any padding");
+
+    constexpr char NETWORK_MAGIC[4] = { 'L', 'Z', 'N', 'N' };
+    constexpr uint32_t NETWORK_VERSION = 1;
 
 
     // ---------------------
@@ -56,6 +115,26 @@ namespace Evaluation {
     };
 
 
+    // -----------------------------
+    // NNUE - feature transformation
+    // -----------------------------
+
+    // Loading feature transformer weights
+    // - Vectorized, SIMD implementation
+    // - Loads 16 consecutive weights as 16-bit integers quantized with QA, regardless of the storage type
+    inline __m256i load_weights(const int16_t* weights)
+    {
+        return _mm256_load_si256(reinterpret_cast<const __m256i*>(weights));
+    }
+
+    inline __m256i load_weights(const int8_t* weights)
+    {
+        __m256i values = _mm256_cvtepi8_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(weights)));
+
+        return _mm256_slli_epi16(values, QA_INT8_SHIFT);
+    }
+
+
     // --------------------------
     // NNUE - activation function
     // --------------------------
@@ -86,14 +165,72 @@ namespace Evaluation {
     // NNUE
     // ----
 
-    // Represents an evaluation network
-    class NNUE
+    // Network parameters - weights and biases
+    // - Parameters are immutable once loaded, which allows to share them between many networks (and threads)
+    // - Shared pointer to parameters can be swapped between searches, which allows to replace the network without touching its state
+    template <uint32_t AccumulatorSize>
+    struct NetworkWeights
+    {
+        // Loading & saving network parameters
+        // - Quantization type is read from the file header
+        // - Saving with different quantization than the loaded one allows to convert network files (for example, INT16 -> INT8)
+        // - WARNING: load() throws if the file does not match network architecture, is truncated or corrupted
+        void load(const std::string& filepath);
+        void save(const std::string& filepath, Quantization file_quantization) const;
+
+        // Helper functions - file format
+        // - parameters_size() returns the number of bytes taken by network parameters in a file of given quantization
+        // - parameters_hash() calculates hash of currently loaded parameters, in the same order as they are stored in a file
+        static std::size_t parameters_size(Quantization file_quantization);
+        uint64_t parameters_hash() const;
+
+        // Feature transformer weights of given storage type
+        // - NOTE: values have a bit of a counter-intuitive shape, but INPUT_SIZE must come first for intrinsics to work properly
+        template <typename WeightT>
+        struct alignas(32) FeatureWeights
+        {
+            WeightT values[INPUT_SIZE][AccumulatorSize] = {};
+        };
+
+        // NNUE components - weights and biases
+        // - Using 16-bit integers allows for better optimization of dynamic update calculation
+        // - Alignment to 32 bits for AVX instructions effectivness
+        // - NOTE: only the feature transformer weights of network quantization are allocated, the other pointer is always empty
+        std::unique_ptr<FeatureWeights<int16_t>> accumulator_weights = std::make_unique<FeatureWeights<int16_t>>();
+        std::unique_ptr<FeatureWeights<int8_t>> accumulator_weights_int8;
+        alignas(32) int16_t accumulator_biases[AccumulatorSize];
+        alignas(32) int16_t output_weights[OUTPUT_BUCKETS][2 * AccumulatorSize];
+        alignas(32) int16_t output_bias[OUTPUT_BUCKETS];
+
+        // Network quantization
+        Quantization quantization = Quantization::INT16;
+    };
+
+    // Represents an evaluation network with given accumulator size
+    // - Template parameter allows to use smaller (faster) or bigger (stronger) networks with the same code
+    // - Network files are validated against the architecture when loading, so a network of wrong size is rejected
+    template <uint32_t AccumulatorSize>
+    class Network
     {
     public:
-        NNUE() = default;
+        static_assert(AccumulatorSize % 16 == 0, "Accumulator size must be a multiple of AVX2 vector size");
+
+        using Weights = NetworkWeights<AccumulatorSize>;
 
-        // Loading network parameters
+        // Network starts with all parameters set to zero
+        Network() : m_weights(std::make_shared<Weights>()) {}
+
+        // Loading & saving network parameters
+        // - Parameters are loaded into a new object, so on failure the network keeps its previous parameters
+        // - See NetworkWeights for details
         void load(const std::string& filepath);
+        void save(const std::string& filepath, Quantization quantization) const { m_weights->save(filepath, quantization); }
+
+        // Replacing network parameters
+        // - Parameters are shared, so many networks can use the same weights without copying them
+        // - NOTE: accumulators are not updated automatically, set() needs to be called before the next forward pass
+        void set_weights(std::shared_ptr<const Weights> weights) { assert(weights); m_weights = std::move(weights); }
+        const std::shared_ptr<const Weights>& weights() const { return m_weights; }
 
         // Network updates
         // - Static update (set): recalculates all accumulator values from scratch
@@ -108,18 +245,20 @@ namespace Evaluation {
         // Forward pass
         int32_t forward(const Board& board);
 
-    private:
-        // Helper functions - lazy update handlers
-        void make_updates();
+        // Batch forward pass
+        // - Evaluates many independent positions at once, without touching the accumulator stack
+        // - Equivalent of calling set() and forward() for each position, but with much better throughput
+        // - Does not modify network state, which allows to split the work between given number of threads
+        // - WARNING: results must have at least the same size as boards
+        void forward(std::span<const Board> boards, std::span<int32_t> results, unsigned threads = 1) const;
 
-        // NNUE components - weights and biases
-        // - Using 16-bit integers allows for better optimization of dynamic update calculation
-        // - Alignment to 32 bits for AVX instructions effectivness
-        // - NOTE: m_accumulator_weights has a bit of a counter-intuitive shape, but INPUT_SIZE must come first for intrinsics to work properly
-        alignas(32) int16_t m_accumulator_weights[INPUT_SIZE][ACCUMULATOR_SIZE];
-        alignas(32) int16_t m_accumulator_biases[ACCUMULATOR_SIZE];
-        alignas(32) int16_t m_output_weights[OUTPUT_BUCKETS][2 * ACCUMULATOR_SIZE];
-        alignas(32) int16_t m_output_bias[OUTPUT_BUCKETS];
+        // Getters
+        Quantization quantization() const { return m_weights->quantization; }
+        static constexpr uint32_t accumulator_size() { return AccumulatorSize; }
+
+    private:
+        // NNUE components - weights and biases (shared)
+        std::shared_ptr<const Weights> m_weights;
 
         // NNUE components - accumulators
         // - Accumulator is a network layer wchich "accumulates" input values, storing them and allowing for dynamic update
@@ -127,22 +266,40 @@ namespace Evaluation {
         // - Depending on who is on move we either treat acc_white or acc_black as side to move accumulator
         struct alignas(32) Accumulator
         {
-            int16_t values[ACCUMULATOR_SIZE];
+            int16_t values[AccumulatorSize];
 
             // Those functions look quite ugly, but merging smaller ones into bigger ones allows for further optimization (fused updates)
-            void add_sub(Accumulator* prev, int16_t weights[][ACCUMULATOR_SIZE], 
+            // - WeightT is a storage type of feature transformer weights (see Quantization)
+            template <typename WeightT>
+            void add_sub(const Accumulator* prev, const WeightT weights[][AccumulatorSize], 
                          uint32_t add_idx, uint32_t sub_idx);
-            void add_sub_sub(Accumulator* prev, int16_t weights[][ACCUMULATOR_SIZE],
+            template <typename WeightT>
+            void add_sub_sub(const Accumulator* prev, const WeightT weights[][AccumulatorSize],
                              uint32_t add_idx, uint32_t sub_idx_1, uint32_t sub_idx_2);
-            void add_add_sub_sub(Accumulator* prev, int16_t weights[][ACCUMULATOR_SIZE],
+            template <typename WeightT>
+            void add_add_sub_sub(const Accumulator* prev, const WeightT weights[][AccumulatorSize],
                                  uint32_t add_idx_1, uint32_t add_idx_2, uint32_t sub_idx_1, uint32_t sub_idx_2);
         };
 
-        // Accumulators are indexed by ply index
+        // Accumulators are indexed by ply index and perspective
         // - This allows to optimize network since unmake move now requires just decrementing the ply pointer
-        alignas(32) Accumulator m_acc_white[MAX_PLY];
-        alignas(32) Accumulator m_acc_black[MAX_PLY];
+        // - Both perspectives of given ply are placed next to each other, since they are always updated and read together
+        alignas(32) Accumulator m_accumulators[MAX_PLY][COLOR_RANGE];
         
+        // Helper functions - lazy update handlers
+        void make_updates();
+        template <typename WeightT>
+        void make_updates(const WeightT weights[][AccumulatorSize]);
+
+        // Helper functions - accumulator handlers
+        // - refresh() calculates accumulators of both perspectives from scratch for given position
+        // - output() applies output layer on top of already prepared accumulators (indexed by perspective)
+        void refresh(const Board& board, Accumulator accumulators[COLOR_RANGE]) const;
+        template <typename WeightT>
+        void refresh(const Board& board, Accumulator accumulators[COLOR_RANGE], const WeightT weights[][AccumulatorSize]) const;
+        int32_t output(const Board& board, const Accumulator accumulators[COLOR_RANGE]) const;
+        void forward_range(std::span<const Board> boards, std::span<int32_t> results) const;
+
         // NNUE components - update stack
         // - To consider NNUE as ready at ply P, all changes from updates[0] up to updates[P] (excluding updates[P]) must be applied
         // - This basically implements lazy updates, where changes are applied only when evaluation needs to be called, instead of after every move
@@ -153,4 +310,17 @@ namespace Evaluation {
         int m_last_ready_ply = 0;  // Points to the last ply at which accumulators are properly updated
     };
 
-}
\ No newline at end of file
+    // Networks of supported sizes are instantiated in nnue.cpp
+    extern template struct NetworkWeights<256>;
+    extern template struct NetworkWeights<512>;
+    extern template struct NetworkWeights<1024>;
+
+    extern template class Network<256>;
+    extern template class Network<512>;
+    extern template class Network<1024>;
+
+    // Network used by the engine
+    // - Size of this network is chosen at build time (see ACCUMULATOR_SIZE)
+    class NNUE : public Network<ACCUMULATOR_SIZE> {};
+
+}
@@ -99,7 +99,7 @@ namespace Pieces {
         int size = 0;
 
         // Magic values must be initilized for all possible placement of piece
-        for (int sq = 0; sq < SQUARE_RANGE; sq++) {
+        for (uint32_t sq = 0; sq < SQUARE_RANGE; sq++) {
             // Since attack maps do not change if we put any blockers on edge files or ranks, we can extract them
             // to make index smaller
             Bitboard edges = ((Chessboard::RANK_1 | Chessboard::RANK_8) & ~Chessboard::rank(rank_of(Square(sq)))) |
@@ -149,7 +149,7 @@ namespace Pieces {
         initialize_magics(RookMagics, RookTable, Calculation::rook_attacks);
 		initialize_magics(BishopMagics, BishopTable, Calculation::bishop_attacks);
 
-		for (int sq = SQ_A1; sq <= SQ_H8; ++sq) {
+		for (uint32_t sq = SQ_A1; sq <= SQ_H8; ++sq) {
 			Bitboard squareBB = square_to_bb(Square(sq));
 			PawnAttacks[WHITE][sq] = pawn_attacks<WHITE>(squareBB);
 			PawnAttacks[BLACK][sq] = pawn_attacks<BLACK>(squareBB);
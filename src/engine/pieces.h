@@ -109,7 +109,7 @@ namespace Pieces {
 
     // General static version - for knight & king attacks
     template <PieceType ptype>
-    inline Bitboard piece_attacks_s(Square sq, Bitboard occ = 0)
+    inline Bitboard piece_attacks_s(Square sq, [[maybe_unused]] Bitboard occ = 0)
     {
         return PseudoAttacks[ptype][sq];
     }
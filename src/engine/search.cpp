@@ -9,10 +9,11 @@ namespace Search {
     // Search - crawlers - search API
     // ------------------------------
 
-    Score Crawler::search(Depth depth)
+    template <Instrumentation Stats>
+    Score Crawler<Stats>::search(Depth depth)
     {
-        // Reset node counters
-        non_leaf_nodes = leaf_nodes = qs_nodes = 0;
+        // Reset statistics
+        m_stats.reset();
 
         // Prepare search stack
         // Reset all the search stack data, that is not being reset after every make & unmake of move
@@ -23,6 +24,7 @@ namespace Search {
         // - We can achieve that by pushing it will null move, which then will be discarded with static changes
         // - This just ensures that next ply data is valid without additional code
         m_sstop = m_search_stack;         // First we point to the guard
+        m_sstop->continuation = m_history->continuation(NO_PIECE, SQ_A1);
         make_move(Moves::null, true);     // Then we move from guard to first real entry (without changing board state)
 
         // Decide on whether to use LMR heuristic in current search or not
@@ -42,27 +44,32 @@ namespace Search {
     // Search - crawlers - search components - main search
     // ---------------------------------------------------
 
+    template <Instrumentation Stats>
     template <Node node>
-    Score Crawler::search(Score alpha, Score beta, Depth depth, bool nmp_available)
+    Score Crawler<Stats>::search(Score alpha, Score beta, Depth depth, bool nmp_available)
     {
-        // TEST & DEBUG
         // Update node counters
-        if (depth <= 0)
-            leaf_nodes++;
-        else
-            non_leaf_nodes++;
+        m_stats.count_node(depth);
 
         // Save current search depth
         m_sstop->depth = depth;
 
         // Step 1 - detect draws within game rules
         // ---------------------------------------
-        // - Possible draws include draw by 50-move rule or by 3-fold repetitions
+        // - Possible draws include draw by 50-move rule, by 3-fold repetitions or by insufficient material
         // - We also consider 2-fold repetition as a draw if repetition happened in the same search tree
 
         // 50-move rule
         if (m_virtual_board.halfmoves_c() >= 100)
             return 0;
+
+        // Insufficient material
+        // - Material table is probed once per node, and its analysis is reused by static evaluation and NMP
+        // - Entry is copied, since deeper nodes may replace it in the table
+        const Evaluation::MaterialEntry material = m_material_table.probe(m_virtual_board.material_key());
+
+        if (node != ROOT_NODE && material.insufficient_material)
+            return 0;
         
         // Repetitions
         auto [repetitions, repetition_dist] = m_virtual_board.repetitions();
@@ -71,9 +78,18 @@ namespace Search {
         // a) 50-move rule occured
         // b) 3-fold repetition occured
         // c) 2-fold repetition in current search tree occured
-        if (repetitions == 3 || repetitions == 2 && m_sstop->ply >= repetition_dist)
+        if (repetitions == 3 || (repetitions == 2 && m_sstop->ply >= repetition_dist))
             return 0;
 
+        // Upcoming repetition
+        // - If side to move can repeat a position from the current search tree with a single move, it can at least force a draw
+        // - Detected one ply earlier than the repetition itself, with O(1) cuckoo table lookups
+        if (node != ROOT_NODE && alpha < 0 && m_virtual_board.upcoming_repetition(m_sstop->ply)) {
+            alpha = 0;
+            if (alpha >= beta)
+                return alpha;
+        }
+
 
         // Step 2 - transposition table probe
         // ----------------------------------
@@ -84,12 +100,14 @@ namespace Search {
 
         Score tt_score = Evaluation::NO_EVAL;
         EMove tt_move = Moves::null;
+        bool tt_move_drawn = false;
 
         if (tt_entry) {
-            // DEBUG
-            // Test if transposition table move is fine (helps detecting hash collisions)
+            // Transposition table move has to be validated, since hash collisions are possible
+            // - This is the only legality check of transposition table move, move selector relies on it (see step 5)
             if (tt_entry->best_move != Moves::null && !m_virtual_board.is_legal_f(tt_entry->best_move)) {
-                std::cout << "Illegal transposition table move!\n";
+                if constexpr (VALIDATION_LEVEL == Validation::FULL)
+                    std::cout << "Illegal transposition table move!\n";
                 goto next_step;
             }
 
@@ -104,10 +122,10 @@ namespace Search {
             // - CUT_NODE requires additional condition of score being not less than current beta
             // - ALL_NODE requires additional condition of score being less than current alpha
             if (tt_entry->node_type == TERMINAL_NODE ||
-                tt_entry->depth >= depth && 
-                (tt_entry->node_type == PV_NODE || 
-                 tt_entry->node_type == CUT_NODE && tt_entry->score >= beta ||
-                 tt_entry->node_type == ALL_NODE && tt_entry->score < alpha))
+                (tt_entry->depth >= depth && 
+                 (tt_entry->node_type == PV_NODE || 
+                  (tt_entry->node_type == CUT_NODE && tt_entry->score >= beta) ||
+                  (tt_entry->node_type == ALL_NODE && tt_entry->score < alpha))))
             {
                 // Additional protection against repetition cycles
                 // - Repetition cycle is a situation, where transposition table in position A points to position B, and in B to A
@@ -127,55 +145,52 @@ namespace Search {
                 
                 // In other case, we assume that move pointed out by transposition table leads to a draw
                 tt_score = 0;
-            }
-            // If cut-off is not possible, then try transposition table move and perform standard search
-            else if (depth > 0 && tt_move != Moves::null) {
-                make_move(tt_move);
-                tt_score = -search<PV_NODE>(-beta, -alpha, depth - 1, true);
-                undo_move();
-            }
-
-            // Case 1 - best score reached
-            if (tt_score > m_sstop->score && tt_move != Moves::null) {
-                m_sstop->score = tt_score;
-                m_sstop->best_move = tt_move;
-                if (tt_score > alpha) {
-                    alpha = tt_score;
-                    m_sstop->node = PV_NODE;
+                tt_move_drawn = true;
+
+                // Case 1 - best score reached
+                if (tt_score > m_sstop->score) {
+                    m_sstop->score = tt_score;
+                    m_sstop->best_move = tt_move;
+                    if (tt_score > alpha) {
+                        alpha = tt_score;
+                        m_sstop->node = PV_NODE;
+                    }
                 }
-            }
 
-            // Case 2 - beta cut-off
-            if (tt_score != Evaluation::NO_EVAL && tt_score >= beta) {
-                m_sstop->node = CUT_NODE;
+                // Case 2 - beta cut-off
+                if (tt_score >= beta) {
+                    m_sstop->node = CUT_NODE;
+                    m_stats.count_cutoff(MoveOrdering::StagedSelector::TT_MOVE);
+
+                    m_ttable->set({
+                        m_virtual_board.hash(),
+                        m_virtual_board.pieces(),
+                        m_search_stack[1].age,              // Root age
+                        m_virtual_board.halfmoves_p(),      // Current age
+                        depth,
+                        CUT_NODE,
+                        tt_score,  // score
+                        tt_move,
+                        tt_entry->static_eval
+                    });
+
+                    // Killer & counter move heuristic update
+                    if (tt_move.is_quiet() || !m_virtual_board.see_ge(tt_move, 1))
+                        m_sstop->add_killer(tt_move);
+                    if (tt_move.is_quiet())
+                        m_history->update_counter_move(m_sstop->continuation, tt_move);
+
+                    // History heuristic update
+                    // - Since move is best at current node, we update it's score with 1 (MAX_HISTORY_SCORE)
+                    // - There are no other moves which would have been tried before tt_move, so we can update only for tt_move
+                    update_history(tt_move, HISTORY_CUT_FACTOR, depth, HISTORY_MAX_SCORE);
 
-                m_ttable->set({
-                    m_virtual_board.hash(),
-                    m_virtual_board.pieces(),
-                    m_search_stack[1].age,              // Root age
-                    m_virtual_board.halfmoves_p(),      // Current age
-                    depth,
-                    CUT_NODE,
-                    tt_score,  // score
-                    tt_move,
-                    tt_entry->static_eval
-                });
-
-                // Killer heuristic update
-                if (tt_move.is_quiet() || m_virtual_board.see(tt_move) <= 0)
-                    m_sstop->add_killer(tt_move);
-
-                // History heuristic update
-                // - Since move is best at current node, we update it's score with 1 (MAX_HISTORY_SCORE)
-                // - There are no other moves which would have been tried before tt_move, so we can update only for tt_move
-                m_history->update(m_virtual_board, tt_move, 
-                                  HISTORY_CUT_FACTOR, m_search_stack[1].depth, depth, m_sstop->ply, HISTORY_MAX_SCORE);
-
-                return tt_score;
-            }
+                    return tt_score;
+                }
 
-            if (tt_move != Moves::null)
                 m_sstop->move_idx++;
+            }
+            // If cut-off is not possible, transposition table move is searched first by the move selector (see step 5)
 
             // Get evaluations from transposition table enrty
             m_sstop->static_eval = tt_entry->static_eval;
@@ -198,7 +213,7 @@ namespace Search {
         // - We can use value extracted from transposition table if there is one available
 
         if (m_sstop->static_eval == Evaluation::NO_EVAL)
-            m_sstop->static_eval = evaluate();
+            m_sstop->static_eval = evaluate(material);
         
         // Step 4 - NMP (Null Move Pruning) heuristic
         // ------------------------------------------
@@ -213,7 +228,7 @@ namespace Search {
         //       This hopes to improve move ordering and thus gain search speed
         if (nmp_available && depth > 1 &&
             !m_virtual_board.in_check() &&
-            m_virtual_board.game_stage() > Evaluation::GameStage::SINGLE_ROOK_VS_ROOK_ENDGAME &&
+            material.game_stage > Evaluation::GameStage::SINGLE_ROOK_VS_ROOK_ENDGAME &&
            (m_sstop->eval == Evaluation::NO_EVAL || m_sstop->eval >= beta) &&
             m_sstop->static_eval >= std::max(beta - 20 * depth + 240, beta + NPM_THRESHOLD))
         {
@@ -261,138 +276,83 @@ namespace Search {
             }
         }
 
-        // Step 5 - move generation & mate / stealmate detection
-        // -----------------------------------------------------
-        // - Mate occurs when side to move has no legal moves while being in check
-        // - Stealmate occurs when side to move has no legal moves while not being in check
-
-        // For better move ordering, we should always start with captures unless side to move is in check
-        MoveGeneration::Mode mode = m_virtual_board.in_check() ? MoveGeneration::CHECK_EVASION : MoveGeneration::PSEUDO_LEGAL;
-
-        MoveOrdering::Selector move_selector(&m_virtual_board, mode);
-
-        // Detect mate & stealmate
-        if (!move_selector.has_next()) {
-            // For mate we use score = infinity (certain win), for stealmate we use score = 0 (draw)
-            // - We use different mate score for mate in 1, mate in 2, etc.
-            // - Quickest path to mate gets the highest score, which allows engine to converge into mate
-            Score score = m_virtual_board.in_check() ? -Evaluation::MAX_EVAL + m_sstop->ply : 0;
-
-            m_ttable->set({
-                m_virtual_board.hash(),
-                m_virtual_board.pieces(),
-                m_search_stack[1].age,              // Root age
-                m_virtual_board.halfmoves_p(),      // Current age
-                depth,
-                TERMINAL_NODE,
-                score,
-                Moves::null,
-                m_sstop->static_eval
-            });
-
-            return score;
-        }
-
-        // Step 6 - move ordering strategies
-        // ---------------------------------
-        // - History heuristic application
-        // - Order: winning captures (SEE > 0) first, then all moves ordered by history scores
-
-        MoveOrdering::sort(move_selector, [this](const Move& move) -> int32_t {
+        // Step 5 - staged move selection
+        // -------------------------------
+        // - Moves are generated lazily in stages: transposition table move, good captures, killers, counter move, quiet moves
+        //   and bad captures
+        // - Killer heuristic focuses on ordering high moves that caused cut-offs in sibling nodes
+        // - Counter move heuristic tries the quiet move that most recently refuted opponent's last move
+        // - History heuristic (with continuation history) orders quiet moves, while captures are ordered by captured piece value (MVV) and capture history
+        // - Captures are split by SEE into good and bad ones by the selector, and in evasions they all go before quiet moves
+        // - Quiet moves escaping from the square attacked in NMP search, or capturing the attacking piece, go before other quiet moves
+        // - Transposition table move, which is assumed to lead to a draw, was already tried and is excluded from selection
+
+        auto move_indexer = [this, target_from_sq, target_to_sq](const Move& move) -> int32_t {
             if (!move.is_quiet()) {
-                int32_t see = this->m_virtual_board.see(move);
-                if (see > 0)    // Prioritize winning captures and promotions
-                    return HISTORY_MAX_SCORE + see;
+                int32_t mvv = Evaluation::PieceValues[History::captured_type(this->m_virtual_board, move)] + 
+                              Evaluation::PieceValues[move.promotion_type()];
+                return HISTORY_MAX_SCORE + CAPTURE_HISTORY_MVV_FACTOR * mvv + this->history_score(move);
             }
             
-            return this->m_history->score(this->m_virtual_board, move);
-        });
+            if (move.from() == target_from_sq || move.to() == target_to_sq)
+                return HISTORY_MAX_SCORE;
+
+            return this->history_score(move);
+        };
 
-        // Step 7 - main search loop
+        MoveOrdering::StagedSelector move_selector(&m_virtual_board, tt_move_drawn ? Moves::null : Move(tt_move), m_sstop->killers,
+                                                   m_history->counter_move(m_sstop->continuation));
+
+        // Step 6 - main search loop
         // -------------------------
         // - Iterates over set of legal moves, recursively going down with depth
 
         // Some flow control variables
         EMove move;
-        int next_killer = 0;
 
         // History heuristic variables
         // - List of moves to remember every move tried and apply appropriate score after calculating best move and best score
         Moves::List<EMove, HISTORY_NO_MOVES> moves_tried;
 
-        // Before entering main loop, exclude transposition table suggestion from move selection
+        // Drawn transposition table move was already tried, so it needs to be remembered for history heuristic
         // - Another occurance of previously analyzed move would have a bad effect for LMR heuristic
-        if (tt_move != Moves::null) {
+        if (tt_move_drawn) {
             move_selector.exclude(tt_move);
 
             tt_move.enhance(Moves::Enhancement::PURE_SEARCH_SCORE, tt_score);
             moves_tried.push_back(tt_move);
         }
-
-        // Also, apply move ordering changes from NMP data if available
-        if (target_from_sq != NULL_SQUARE && target_to_sq != NULL_SQUARE) {
-            move_selector.strategy.add_rule(mode, [target_from_sq, target_to_sq](const Move& move) -> bool {
-                return move.from() == target_from_sq || move.to() == target_to_sq;
-            });
-        }
         
         // Enter main loop
         // - We use infinite loop with continue/break controls for more flexibility
         while (true) {
 
-            // Since we use only PSEUDO_LEGAL and CHECK_EVASION, we can limit phase change to STRICT
-            // - No additional selection (at least for now)
-            move = move_selector.next(MoveOrdering::Selector::STRICT, true);
+            move = move_selector.next(move_indexer);
 
             if (move == Moves::null)
                 break;
             
             m_sstop->move_idx++;
 
-            // Step 8 - killer heuristic
-            // -------------------------
-            // - Killer heuristic focuses on ordering high moves that caused cut-offs in sibling nodes
-            // - Only quiet moves and bad (SEE < 0) captures can be considered as killers, since good and equal captures are already ordered high
-            // - Killer moves are ordered right after winning (SEE > 0) captures
-
-            Move killer;
-
-            // Consider killer moves only after next ordered move is no longer a winning capture
-            if (next_killer < NO_KILLERS && (move.is_quiet() || m_virtual_board.see(move) <= 0)) {
-                killer = m_sstop->killers[next_killer];
-
-                // Check legality of the killer move (full check, since killer might not even be pseudolegal in current position)
-                if (killer != Moves::null && killer != move && m_virtual_board.is_legal_f(killer)) {
-                    // Save generated move for later use
-                    move_selector.restore_last();
-
-                    // Switch to the killer move
-                    move = killer;
-
-                    // Exclude killer move from selection to avoid repeating the same move later
-                    move_selector.exclude(killer);
-                }
-
-                next_killer++;
-            }
-
-            // Step 9 - futility pruning heuristic
+            // Step 7 - futility pruning heuristic
             // -----------------------------------
             // - Futility pruning discards quiet moves near leaf nodes with no perspective of raising alpha
             // - Relies on arbitrary selected parameters which decide whether given position has enough potential to raise alpha
+            // - Transposition table move is never pruned
 
             // We use different evaluation margin for depth 1 and depth 2
             Evaluation::Eval margin = depth == 1 ? FUTILITY_MARGIN_I : FUTILITY_MARGIN_II;
 
             if (depth <= 2 &&
                 m_sstop->static_eval + margin < alpha &&
+                move_selector.stage() != MoveOrdering::StagedSelector::TT_MOVE &&
                 !m_virtual_board.in_check() && move.is_quiet() && !m_virtual_board.is_check(move))
             {
                 continue;
             }
 
-            // Step 10 - late move reductions heuristic
-            // ----------------------------------------
+            // Step 8 - late move reductions heuristic
+            // ---------------------------------------
             // - Reduce low ordered (most likely unpromising) moves in depth
             // - Each move type (captures, checks, quiet) has it's individual reduction factor
             // - Most important search heuristic, which allows to almost double effective search depth in given time frame
@@ -409,14 +369,15 @@ namespace Search {
                                       Depth((depth - 2) / 2));
             }
 
-            // Step 11 - search descent
-            // ------------------------
+            // Step 9 - search descent
+            // -----------------------
             // - Try every move with verification search in case of LMR
 
-            // DEBUG
-            // Test if transposition table move is fine (helps detecting hash collisions)
-            if (move != Moves::null && !m_virtual_board.is_legal_f(move))
-                std::cout << "Illegal move in main search loop!\n";
+            // Test if move is fine (helps detecting hash collisions and move generation bugs)
+            if constexpr (VALIDATION_LEVEL == Validation::FULL) {
+                if (move != Moves::null && !m_virtual_board.is_legal_f(move))
+                    std::cout << "Illegal move in main search loop!\n";
+            }
 
             // Make move and search further
             make_move(move);
@@ -450,6 +411,7 @@ namespace Search {
             // Case 2 - beta cut-off
             if (score >= beta) {
                 m_sstop->node = CUT_NODE;
+                m_stats.count_cutoff(move_selector.stage());
 
                 m_ttable->set({
                     m_virtual_board.hash(),
@@ -463,9 +425,12 @@ namespace Search {
                     m_sstop->static_eval
                 });
 
-                // Killer heuristic upate
-                if (move.is_quiet() || m_virtual_board.see(move) <= 0)
+                // Killer & counter move heuristic upate
+                // - SEE sign of captures is usually known from move ordering already
+                if (move.is_quiet() || !(move.see_positive() ? *move.see_positive() : m_virtual_board.see_ge(move, 1)))
                     m_sstop->add_killer(move);
+                if (move.is_quiet())
+                    m_history->update_counter_move(m_sstop->continuation, move);
                 
                 // History heuristic update
                 // - Update current move (best) and all the previous ones (not the best)
@@ -477,15 +442,40 @@ namespace Search {
                     int64_t R = std::clamp(best_score_normalized - best_score + move_score, 0, best_score_normalized);
                     R = History::Score(R * R * HISTORY_MAX_SCORE / (best_score_normalized * best_score_normalized));
 
-                    m_history->update(m_virtual_board, move_tried, 
-                                      HISTORY_CUT_FACTOR, m_search_stack[1].depth, depth, m_sstop->ply, R);
+                    update_history(move_tried, HISTORY_CUT_FACTOR, depth, R);
                 }
 
                 return score;
             }
         }
 
-        // Step 12 - final result registration
+        // Step 10 - mate / stealmate detection
+        // ------------------------------------
+        // - Mate occurs when side to move has no legal moves while being in check
+        // - Stealmate occurs when side to move has no legal moves while not being in check
+
+        if (m_sstop->move_idx == 0) {
+            // For mate we use score = infinity (certain win), for stealmate we use score = 0 (draw)
+            // - We use different mate score for mate in 1, mate in 2, etc.
+            // - Quickest path to mate gets the highest score, which allows engine to converge into mate
+            Score score = m_virtual_board.in_check() ? -Evaluation::MAX_EVAL + m_sstop->ply : 0;
+
+            m_ttable->set({
+                m_virtual_board.hash(),
+                m_virtual_board.pieces(),
+                m_search_stack[1].age,              // Root age
+                m_virtual_board.halfmoves_p(),      // Current age
+                depth,
+                TERMINAL_NODE,
+                score,
+                Moves::null,
+                m_sstop->static_eval
+            });
+
+            return score;
+        }
+
+        // Step 11 - final result registration
         // -----------------------------------
         // - We reach this fragment if no beta cut-off or ny other cut-off occured during main search
 
@@ -512,8 +502,7 @@ namespace Search {
                 int64_t R = std::clamp(best_score_normalized - best_score + score, 0, best_score_normalized);
                 R = History::Score(R * R * HISTORY_MAX_SCORE / (best_score_normalized * best_score_normalized));
 
-                m_history->update(m_virtual_board, move_tried, m_sstop->node == PV_NODE ? HISTORY_PV_FACTOR : HISTORY_ALL_FACTOR,
-                                  m_search_stack[1].depth, depth, m_sstop->ply, R);
+                update_history(move_tried, m_sstop->node == PV_NODE ? HISTORY_PV_FACTOR : HISTORY_ALL_FACTOR, depth, R);
             }
         }
         
@@ -525,11 +514,12 @@ namespace Search {
     // Search - crawlers - search components - quiescence search
     // ---------------------------------------------------------
 
+    template <Instrumentation Stats>
     template <Node node>
-    Score Crawler::quiescence(Score alpha, Score beta, Depth depth)
+    Score Crawler<Stats>::quiescence(Score alpha, Score beta, Depth depth)
     {
         // Update node counters
-        qs_nodes++;
+        m_stats.count_qs_node();
 
         // Step 1 - transposition table probe
         // ----------------------------------
@@ -540,8 +530,8 @@ namespace Search {
             auto tt_entry = m_ttable->probe(m_virtual_board.hash(), m_virtual_board.pieces());
 
             if (tt_entry && (is_pv(tt_entry->node_type) ||
-                             tt_entry->node_type == CUT_NODE && tt_entry->score >= beta ||
-                             tt_entry->node_type == ALL_NODE && tt_entry->score < alpha))
+                             (tt_entry->node_type == CUT_NODE && tt_entry->score >= beta) ||
+                             (tt_entry->node_type == ALL_NODE && tt_entry->score < alpha)))
             {
                 return tt_entry->score;
             }
@@ -593,27 +583,34 @@ namespace Search {
 
         EMove move;
 
+        // Captures which were not searched in this step, for the further quiescence below
+        Moves::List<Move> skipped;
+
         // We omit this step if there are no captures to be made
         // - NOTE: has_next() invoked in mate/stealmate detection could change generation phase from CAPTURE to QUIET_CHECK or QUIET
         if (move_selector.phase() >= MoveGeneration::CAPTURE) {
-            // Sort all the captures by SEE value
-            // - This allows to reduce number of iterations in the main loop below
-            MoveOrdering::sort(move_selector, [this](const Move& move) { return this->m_virtual_board.see(move); }, 
-                                              Moves::Enhancement::PURE_SEE);
+            // Sort all the captures by MVV-LVA
+            // - Quiescence usually cuts off after one or two captures, so SEE is tested only for the move about to be searched
+            MoveOrdering::sort(move_selector, [this](const Move& move) { return this->mvv_lva(move); });
             
             // In this loop we try only winning captures
             while (true) {
                 // NOTE: STRICT mode ensures that we do not go beyond captures in this loop
                 move = move_selector.next(MoveOrdering::Selector::STRICT);
 
-                // Break condition 1 - no more winning captures
-                if (move == Moves::null || move.is_quiet() || move.see().value() <= 0)
+                // Break condition - no more captures (quiet evasions are ordered after all the captures)
+                if (move == Moves::null || move.is_quiet())
                     break;
 
-                // Break condition 2 - no more improving captures in terms of delta pruning
+                // Skip condition - losing captures, and captures which cannot improve alpha in terms of delta pruning
                 // - NOTE: we must check all the possible replies when side to move is in check
-                if (m_sstop->static_eval + move.see().value() + DELTA_MARGIN < alpha && move_selector.phase() != MoveGeneration::CHECK_EVASION)
-                    break;
+                Score threshold = move_selector.phase() != MoveGeneration::CHECK_EVASION ? 
+                                  std::max<Score>(1, alpha - m_sstop->static_eval - DELTA_MARGIN) : 1;
+
+                if (!m_virtual_board.see_ge(move, threshold)) {
+                    skipped.push_back(move);
+                    continue;
+                }
                 
                 // Make move and search further
                 make_move(move);
@@ -643,22 +640,27 @@ namespace Search {
 
         // Typically a single threat can be dealt with in one move, but two separate threats usually mean loss of a material
         if (m_sstop->static_eval + EPSILON_MARGIN > alpha && Bitboards::popcount(threats) > 1) {
-            // Change generation phase if reached the end of previous one
-            // - This time we use FULL_CASCADE since we want to test move regardless of it's category
-            if (move == Moves::null)
-                move = move_selector.next(MoveOrdering::Selector::FULL_CASCADE);
+            // Skipped captures are revisited first, then the move which ended previous step (if any)
+            // - After that, we use FULL_CASCADE since we want to test move regardless of it's category
+            if (move != Moves::null)
+                skipped.push_back(move);
+
+            std::size_t next_skipped = 0;
+            auto next = [&]() -> EMove {
+                return next_skipped < skipped.size() ? EMove(skipped[next_skipped++]) : move_selector.next(MoveOrdering::Selector::FULL_CASCADE);
+            };
             
-            while (move != Moves::null) {
+            for (move = next(); move != Moves::null; move = next()) {
                 PieceType ptype = type_of(m_virtual_board.on(move.to()));
                 Bitboard attacks = ptype == NULL_PIECE_TYPE ? 0 :
                                    ptype == PAWN ? Pieces::pawn_attacks(~m_virtual_board.side_to_move(), move.to()) :
                                                    Pieces::piece_attacks_d(ptype, move.to(), m_virtual_board.pieces());
                 
+                // Captures are recognized by move flags rather than by selector phase, which does not follow the revisited moves
                 if (m_virtual_board.in_check() ||
-                    move_selector.phase() != MoveGeneration::CAPTURE && threats & move.from() ||
-                    move_selector.phase() == MoveGeneration::CAPTURE && 
-                    m_sstop->static_eval + EPSILON_MARGIN + move.see().value() > alpha &&
-                    (threats & move.from() || attacks & threats))
+                    (move.is_quiet() && (threats & move.from())) ||
+                    (!move.is_quiet() && (threats & move.from() || attacks & threats) &&
+                     m_virtual_board.see_ge(move, alpha - m_sstop->static_eval - EPSILON_MARGIN + 1)))
                 {
                     // Make move and search further
                     make_move(move);
@@ -676,8 +678,6 @@ namespace Search {
                             alpha = score;
                     }
                 }
-
-                move = move_selector.next(MoveOrdering::Selector::FULL_CASCADE);
             }
 
             return m_sstop->score;
@@ -691,12 +691,17 @@ namespace Search {
     // Search - crawlers - move make & unmake
     // --------------------------------------
 
-    void Crawler::make_move(const Move& move, bool only_stack)
+    template <Instrumentation Stats>
+    void Crawler<Stats>::make_move(const Move& move, bool only_stack)
     {
         // Do not continue if search stack is full
         if (m_sstop->ply == MAX_TOTAL_SEARCH_DEPTH)
             return;
 
+        // Continuation history is indexed by the moved piece, so it must be read before the move is made
+        History::Continuation* continuation = move != Moves::null ? m_history->continuation(m_virtual_board.on(move.from()), move.to()) :
+                                                                    m_history->continuation(NO_PIECE, SQ_A1);
+
         if (!only_stack) {
             if (move != Moves::null) {
                 // NNUE must be updated before virtual board
@@ -721,9 +726,11 @@ namespace Search {
         m_sstop->static_eval = Evaluation::NO_EVAL;
         m_sstop->eval = Evaluation::NO_EVAL;
         m_sstop->move_idx = 0;
+        m_sstop->continuation = continuation;
     }
 
-    void Crawler::undo_move()
+    template <Instrumentation Stats>
+    void Crawler<Stats>::undo_move()
     {
         // Do not continue if search stack is empty (stack top pointer points to guard)
         if (m_sstop->ply == -1)
@@ -740,4 +747,55 @@ namespace Search {
         m_sstop--;
     }
 
+
+    // ---------------------------------------------
+    // Search - crawlers - history heuristic helpers
+    // ---------------------------------------------
+
+    template <Instrumentation Stats>
+    int32_t Crawler<Stats>::history_score(const Move& move) const
+    {
+        if (!move.is_quiet())
+            return m_history->score(m_virtual_board, move);
+
+        // Main history and both continuation histories are averaged, so the result stays in history score bounds
+        Piece piece = m_virtual_board.on(move.from());
+
+        return (m_history->score(piece, move.to()) + m_history->score(m_sstop->continuation, piece, move.to()) + 
+                m_history->score((m_sstop - 1)->continuation, piece, move.to())) / 3;
+    }
+
+    template <Instrumentation Stats>
+    int32_t Crawler<Stats>::mvv_lva(const Move& move) const
+    {
+        // Quiet evasions get non-positive keys, while every capture or promotion has a positive one
+        if (move.is_quiet())
+            return history_score(move) - HISTORY_MAX_SCORE;
+
+        int32_t mvv = Evaluation::PieceValues[History::captured_type(m_virtual_board, move)] + Evaluation::PieceValues[move.promotion_type()];
+        return PIECE_TYPE_RANGE * mvv - type_of(m_virtual_board.on(move.from()));
+    }
+
+    template <Instrumentation Stats>
+    void Crawler<Stats>::update_history(const Move& move, int c, Depth depth, History::Score R)
+    {
+        m_history->update(m_virtual_board, move, c, m_search_stack[1].depth, depth, m_sstop->ply, R);
+
+        if (move.is_quiet()) {
+            Piece piece = m_virtual_board.on(move.from());
+
+            m_history->update(m_sstop->continuation, piece, move.to(), c, m_search_stack[1].depth, depth, m_sstop->ply, R);
+            m_history->update((m_sstop - 1)->continuation, piece, move.to(), c, m_search_stack[1].depth, depth, m_sstop->ply, R);
+        }
+    }
+
+
+
+    // ------------------------------------------
+    // Search - crawlers - explicit instantiation
+    // ------------------------------------------
+
+    template class Crawler<NoStats>;
+    template class Crawler<SearchStats>;
+
 }
\ No newline at end of file
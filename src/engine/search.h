@@ -2,10 +2,12 @@
 
 #include "board.h"
 #include "history.h"
+#include "material.h"
 #include "moveord.h"
 #include "nnue.h"
 #include "searchconfig.h"
 #include <algorithm>
+#include <concepts>
 
 
 /*
@@ -57,6 +59,58 @@ namespace Search {
     constexpr inline bool is_all(Node node) { return node & ALL_NODE; }
 
 
+    // -----------------------------------
+    // Search - crawlers - instrumentation
+    // -----------------------------------
+
+    // Instrumentation policy decides at compile time which search statistics are collected
+    // - NoStats is used in production, all of its operations are empty, so they are optimized away entirely
+    // - SearchStats collects 64-bit counters, which are owned by each crawler (thread) and aggregated after the search
+    template <typename T>
+    concept Instrumentation = requires(T stats, Depth depth, MoveOrdering::StagedSelector::Stage stage) {
+        { T::enabled } -> std::convertible_to<bool>;
+        stats.reset();
+        stats.count_node(depth);
+        stats.count_qs_node();
+        stats.count_cutoff(stage);
+    };
+
+    struct NoStats
+    {
+        static constexpr bool enabled = false;
+
+        void reset() {}
+        void count_node(Depth) {}
+        void count_qs_node() {}
+        void count_cutoff(MoveOrdering::StagedSelector::Stage) {}
+    };
+
+    struct SearchStats
+    {
+        static constexpr bool enabled = true;
+
+        uint64_t non_leaf_nodes = 0;
+        uint64_t leaf_nodes = 0;
+        uint64_t qs_nodes = 0;
+        uint64_t stage_cutoffs[MoveOrdering::StagedSelector::STAGE_RANGE] = {};       // Beta cut-offs per move selection stage
+
+        void reset() { *this = SearchStats(); }
+        void count_node(Depth depth) { depth <= 0 ? leaf_nodes++ : non_leaf_nodes++; }
+        void count_qs_node() { qs_nodes++; }
+        void count_cutoff(MoveOrdering::StagedSelector::Stage stage) { stage_cutoffs[stage]++; }
+
+        // Aggregation of statistics from many crawlers
+        SearchStats& operator+=(const SearchStats& other) {
+            non_leaf_nodes += other.non_leaf_nodes;
+            leaf_nodes += other.leaf_nodes;
+            qs_nodes += other.qs_nodes;
+            for (uint32_t i = 0; i < MoveOrdering::StagedSelector::STAGE_RANGE; i++)
+                stage_cutoffs[i] += other.stage_cutoffs[i];
+            return *this;
+        }
+    };
+
+
     // -----------------
     // Search - crawlers
     // -----------------
@@ -64,11 +118,15 @@ namespace Search {
     // Crawler is an object that performs search through given branch
     // - Main purpose is to simplify multithreading implementation of main search mechanism
     // - Contains individual (virtual board) and shared (transposition table & others) resources
+    // - Collected statistics are decided by instrumentation policy (Stats), so production search carries no counters at all
+    template <Instrumentation Stats = NoStats>
     class Crawler
     {
     public:
+        using Statistics = Stats;
+
         Crawler(TranspositionTable* ttable, History* history) : 
-            m_ttable(ttable), m_history(history) { m_nnue.load("model/model_best.nnue"); }
+            m_ttable(ttable), m_history(history) { m_virtual_board.reserve(MAX_TOTAL_SEARCH_DEPTH + 1); }
 
         // Search
         // - This is only an API function - the biggest part of search implementation is packed inside helper functions
@@ -76,7 +134,10 @@ namespace Search {
 
         // Static evaluation
         // - Since NNUE already returns a relative value, we do not need any additional conversion
-        Eval evaluate() { return Evaluation::evaluate(m_virtual_board, m_nnue); }
+        // - Material analysis is taken from material table, so no material-related checks are repeated per evaluation
+        // - Search nodes probe material table once and pass the analysis here, the second version probes it by itself
+        Eval evaluate(const Evaluation::MaterialEntry& material) { return Evaluation::evaluate(m_virtual_board, m_nnue, material); }
+        Eval evaluate() { return evaluate(m_material_table.probe(m_virtual_board.material_key())); }
 
         // Position setters
         void set_position(const std::string& fen) { m_virtual_board.load_position(fen); m_nnue.set(m_virtual_board); }
@@ -85,13 +146,15 @@ namespace Search {
         // Position getters
         const Board* get_position() const { return &m_virtual_board; }
 
-        // [TESTING PURPOSES]
-        // Last search data
-        int non_leaf_nodes = 0;
-        int leaf_nodes = 0;
-        int qs_nodes = 0;
+        // Network setter
+        // - Replaces network parameters and recalculates accumulators for current position
+        // - WARNING: must not be called during search
+        void set_network(std::shared_ptr<const Evaluation::NNUE::Weights> weights) { m_nnue.set_weights(std::move(weights)); m_nnue.set(m_virtual_board); }
 
-        friend class Engine;
+        // Statistics of the last search (empty unless instrumentation policy collects them)
+        const Stats& stats() const { return m_stats; }
+
+        friend class ::Engine;
 
     private:
         // Search components
@@ -107,12 +170,25 @@ namespace Search {
         void make_move(const Move& move, bool only_stack = false);
         void undo_move();
 
+        // Helper functions - history heuristic
+        // - Quiet moves are scored with both main history and continuation history of 2 previous moves
+        // - Must be called at the node, where the move is about to be played (or was played and undone)
+        int32_t history_score(const Move& move) const;
+        void update_history(const Move& move, int c, Depth depth, History::Score R);
+
+        // Helper functions - quiescence move ordering
+        // - Captures are ordered by MVV-LVA, which does not require SEE, quiet evasions go last in history order
+        int32_t mvv_lva(const Move& move) const;
+
         // Individual resources - virtual board
         Board m_virtual_board;
 
         // Individual resources - NNUE evaluator
         Evaluation::NNUE m_nnue;
 
+        // Individual resources - material signature cache
+        Evaluation::MaterialTable m_material_table;
+
         // Shared resources - transposition table connection
         TranspositionTable* m_ttable;
 
@@ -149,6 +225,10 @@ namespace Search {
             // Killer heuristic data
             Move killers[NO_KILLERS] = {};
 
+            // Continuation history entry of the move that led to this ply
+            // - Set by make_move(), null move and the root share a dedicated entry
+            History::Continuation* continuation = nullptr;
+
             void add_killer(const Move& killer) {
                 std::rotate(killers, killers + NO_KILLERS - 1, killers + NO_KILLERS);
                 killers[0] = killer;
@@ -166,6 +246,9 @@ namespace Search {
 
         // LMR flag
         bool m_use_lmr = false;
+
+        // Search statistics
+        [[no_unique_address]] Stats m_stats;
     };
 
 }
\ No newline at end of file
@@ -38,6 +38,10 @@ constexpr int HISTORY_CUT_FACTOR = 48;
 // History heuristic - number of analyzed moves (moves_tried list size)
 constexpr int HISTORY_NO_MOVES = 64;
 
+// Capture history - weight of captured piece value (MVV) when combined with capture history score
+// - Captured piece value times the factor is roughly of the same magnitude as the whole history score range
+constexpr int CAPTURE_HISTORY_MVV_FACTOR = 8;
+
 // Killer heuristic
 constexpr int NO_KILLERS = 2;
 
@@ -90,4 +94,21 @@ constexpr double LMR_CAPTURE_FACTOR = 0.7;
 constexpr Evaluation::Eval DELTA_MARGIN = 200;
 
 // Quiescence stop parameter
-constexpr Evaluation::Eval EPSILON_MARGIN = 50;
\ No newline at end of file
+constexpr Evaluation::Eval EPSILON_MARGIN = 50;
+
+
+// -----------------------------------
+// Search parameters - move validation
+// -----------------------------------
+
+// Validation level of moves in main search, decided at compile time
+// - STORED: only moves stored in other nodes (transposition table moves, killers, counter moves) are validated,
+//   which is required for correctness, since they might be illegal in current position
+// - FULL: additionally every searched move is verified and illegal moves are reported (debug builds only)
+enum class Validation { STORED, FULL };
+
+#ifdef NDEBUG
+constexpr Validation VALIDATION_LEVEL = Validation::STORED;
+#else
+constexpr Validation VALIDATION_LEVEL = Validation::FULL;
+#endif
@@ -49,7 +49,7 @@ public:
         Search::Age root_age = 0;       // Together with pieces allows to compare two entries for having the same root (= search tree)
         Search::Age age = 0;            // Age of position related to this entry
 
-        bool same_search_tree(Search::Age root_age, Bitboard pieces) const { return this->root_age == root_age; }
+        bool same_search_tree(Search::Age root_age, [[maybe_unused]] Bitboard pieces) const { return this->root_age == root_age; }
         bool same_search_tree(const Entry& other) const { return same_search_tree(other.root_age, other.pieces); }
 
         // Search results
@@ -71,7 +71,7 @@ public:
                 (*old_entry) = entry;
         }
         else if (!old_entry->same_search_tree(entry) || entry.age < old_entry->age ||
-                 entry.age == old_entry->age && entry.node_type == Search::PV_NODE)
+                 (entry.age == old_entry->age && entry.node_type == Search::PV_NODE))
             (*old_entry) = entry;
     }
 
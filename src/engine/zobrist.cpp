@@ -1,5 +1,6 @@
 #include "zobrist.h"
 #include "board.h"
+#include "pieces.h"
 #include "randomgen.h"
 #include <algorithm>
 #include <unordered_set>
@@ -14,6 +15,14 @@ namespace Zobrist {
     Hash ZobristNumbers[850];
 
 
+    // -------------
+	// Cuckoo tables
+	// -------------
+
+    Hash CuckooKeys[CUCKOO_SIZE];
+    Move CuckooMoves[CUCKOO_SIZE];
+
+
     // ---------------
 	// Zobrist methods
 	// ---------------
@@ -24,7 +33,7 @@ namespace Zobrist {
         m_hash = 0;
 
         // Piece placement hash
-        for (int sq = 0; sq < SQUARE_RANGE; sq++) {
+        for (uint32_t sq = 0; sq < SQUARE_RANGE; sq++) {
             Piece piece = board.on(Square(sq));
             if (piece != NO_PIECE)
                 update(piece, Square(sq));
@@ -37,6 +46,19 @@ namespace Zobrist {
         update(board.enpassant_square());
     }
 
+    Hash generate_pawn_hash(const Board& board)
+    {
+        Hash hash = 0;
+
+        Bitboard pawns = board.pieces(PAWN);
+        while (pawns) {
+            Square sq = Bitboards::pop_lsb(pawns);
+            hash ^= piece_hash(board.on(sq), sq);
+        }
+
+        return hash;
+    }
+
 
     // --------------
 	// Initialization
@@ -64,6 +86,52 @@ namespace Zobrist {
 
             return code;
         });
+
+        // Cuckoo tables depend on Zobrist numbers, so they must be initialized afterwards
+        initialize_cuckoo_tables();
+    }
+
+    // Requires attack tables to be initialized first
+    void initialize_cuckoo_tables()
+    {
+        std::fill(CuckooKeys, CuckooKeys + CUCKOO_SIZE, 0);
+        std::fill(CuckooMoves, CuckooMoves + CUCKOO_SIZE, Moves::null);
+
+        for (Color side : { WHITE, BLACK }) {
+            for (PieceType ptype = KNIGHT; ptype <= KING; ptype = PieceType(ptype + 1)) {
+                Piece piece = make_piece(side, ptype);
+
+                for (uint32_t sq1 = 0; sq1 < SQUARE_RANGE; sq1++) {
+                    for (uint32_t sq2 = sq1 + 1; sq2 < SQUARE_RANGE; sq2++) {
+                        if (!(Pieces::piece_attacks_d(ptype, Square(sq1), 0) & Square(sq2)))
+                            continue;
+
+                        // Hash difference of the move
+                        Zobrist zobrist;
+                        zobrist.update(piece, Square(sq1));
+                        zobrist.update(piece, Square(sq2));
+                        zobrist.update(side);
+
+                        Hash key = zobrist.hash();
+                        Move move(Square(sq1), Square(sq2), Moves::QUIET_MOVE_FLAG);
+
+                        // Cuckoo insertion - push the key into its slot and move the replaced one into its alternative slot,
+                        // up until an empty slot is found
+                        uint32_t i = cuckoo_h1(key);
+
+                        while (true) {
+                            std::swap(CuckooKeys[i], key);
+                            std::swap(CuckooMoves[i], move);
+
+                            if (move == Moves::null)
+                                break;
+
+                            i = i == cuckoo_h1(key) ? cuckoo_h2(key) : cuckoo_h1(key);
+                        }
+                    }
+                }
+            }
+        }
     }
 
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "moves.h"
 #include "types.h"
 
 // Forestall declarations
@@ -24,6 +25,7 @@ namespace Zobrist {
 	// -------------
 
     void initialize_zobrist_numbers();
+    void initialize_cuckoo_tables();        // Called by initialize_zobrist_numbers()
 
 
     // ---------------------
@@ -40,6 +42,9 @@ namespace Zobrist {
     // - 1 element corresponds to distinguish white to move vs black to move positions
     extern Hash ZobristNumbers[850];
 
+    // Hash of a single piece placement
+    inline Hash piece_hash(Piece piece, Square sq) { return ZobristNumbers[color_of(piece) * 384 + type_of(piece) * 64 + sq]; }
+
 
     // ------------------------
 	// Zobrist - main mechanism
@@ -56,10 +61,10 @@ namespace Zobrist {
         void generate(const Chessboard::Board& board);   // Generate hash from scratch for given position
 
         // Dynamic hash update
-        void update(Piece piece, Square sq) { m_hash ^= ZobristNumbers[color_of(piece) * 384 + type_of(piece) * 64 + sq]; }  
+        void update(Piece piece, Square sq) { m_hash ^= piece_hash(piece, sq); }
         void update(CastlingRights rights)  { m_hash ^= ZobristNumbers[768 + rights]; }
         void update(Square epsquare)        { m_hash ^= ZobristNumbers[784 + epsquare]; }       
-        void update(Color side2move)        { m_hash ^= ZobristNumbers[849]; }
+        void update(Color /* side2move */)  { m_hash ^= ZobristNumbers[849]; }
 
         // Getters
         Hash hash() const { return m_hash; }
@@ -69,4 +74,38 @@ namespace Zobrist {
         Hash m_hash = 0;
     };
 
-}
\ No newline at end of file
+    // Pawn structure hash
+    // - Covers only placement of pawns (of both sides), so it's shared between all positions with the same pawn structure
+    // - Board updates pawn hash dynamically, this function generates it from scratch
+    Hash generate_pawn_hash(const Chessboard::Board& board);
+
+
+    // -------------------------------------
+	// Zobrist - cuckoo tables (repetitions)
+	// -------------------------------------
+
+    // Cuckoo tables contain hash differences of all reversible moves (non-pawn moves of both colors on an empty board)
+    // - Hash difference of a move covers piece placement before and after the move, together with side to move change
+    // - If hash difference between current position and some earlier position equals one of the keys, then a single move
+    //   might lead back to that earlier position (upcoming repetition)
+    // - Each key has 2 possible slots (cuckoo hashing), so that a lookup is always O(1)
+    // - Initialized together with Zobrist numbers
+    constexpr uint32_t CUCKOO_SIZE = 8192;
+
+    extern Hash CuckooKeys[CUCKOO_SIZE];
+    extern Move CuckooMoves[CUCKOO_SIZE];
+
+    // Cuckoo hash functions
+    inline uint32_t cuckoo_h1(Hash key) { return key & (CUCKOO_SIZE - 1); }
+    inline uint32_t cuckoo_h2(Hash key) { return (key >> 16) & (CUCKOO_SIZE - 1); }
+
+    // Returns reversible move with given hash difference, or null move if there is no such move
+    inline Move cuckoo_move(Hash key) {
+        return CuckooKeys[cuckoo_h1(key)] == key ? CuckooMoves[cuckoo_h1(key)] :
+               CuckooKeys[cuckoo_h2(key)] == key ? CuckooMoves[cuckoo_h2(key)] : Moves::null;
+    }
+
+    // Side to move hash
+    inline Hash side_hash() { return ZobristNumbers[849]; }
+
+}
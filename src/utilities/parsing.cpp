@@ -85,11 +85,11 @@ namespace Parsing {
             std::size_t notationSize = notation.back() == '+' ? notation.size() - 1 : notation.size();
 
             // Single disambiguated move
-            if (!isCapture && notationSize == 4 || isCapture && notationSize == 5)
+            if ((!isCapture && notationSize == 4) || (isCapture && notationSize == 5))
                 fromArea &= isalpha(notation[1]) ? Chessboard::file(File(notation[1] - 'a')) :
                                                    Chessboard::rank(Rank(notation[1] - '1'));
             // Double disambiguated move
-            else if (!isCapture && notationSize == 5 || isCapture && notationSize == 6)
+            else if ((!isCapture && notationSize == 5) || (isCapture && notationSize == 6))
                 fromArea &= square_to_bb(parse_square(notation.substr(1, 2)));
 
             to = parse_square(notation.substr(notationSize - 2, 2));
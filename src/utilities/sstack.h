@@ -1,7 +1,8 @@
 #pragma once
 
 #include <algorithm>
-#include <vector>
+#include <cstddef>
+#include <memory>
 
 
 /*
@@ -9,10 +10,10 @@
 
     This file contains a template definition of so called "stable stack".
     - Stable stack is a stack with no memory release up until the final destruction of an object
-    - Removing an element from the stack only results in decrementing the element counter, but does not free memory
-    - Adding an element only increments the element counter, unless container is already full - only then
-      we create new element object instead of reusing the one from memory
-    - Dynamic size achieved by using std::vector
+    - Memory is preallocated for given capacity (arena), and removing or adding an element only moves the top pointer
+    - Top access is pointer-based, so top() and top_n() are just a single memory access
+    - If capacity is exceeded, the stack is reallocated with doubled capacity - this should never happen in hot paths,
+      so capacity should be reserved upfront for known bounds (for example, game length + search depth)
     - NOTE: elements stored on stable stack must have a default constructor available
 */
 
@@ -20,30 +21,63 @@ template <typename T>
 class StableStack
 {
 public:
-    // Initialize container with some basic capacity
-    StableStack() : data(32) {}
+    // Default capacity used when no other is specified
+    static constexpr std::size_t DEFAULT_CAPACITY = 32;
+
+    // Preallocate memory for given number of elements
+    explicit StableStack(std::size_t capacity = DEFAULT_CAPACITY) :
+        m_data(std::make_unique<T[]>(capacity)), m_end(m_data.get()), m_limit(m_data.get() + capacity) {}
+
+    // Copying - only the logical part of the stack is copied, with the same capacity
+    StableStack(const StableStack& other) : StableStack(other.capacity()) { *this = other; }
+    StableStack& operator=(const StableStack& other) {
+        if (this != &other) {
+            if (capacity() < other.size())
+                *this = StableStack(other.capacity());
+            m_end = std::copy(other.m_data.get(), other.m_end, m_data.get());
+        }
+        return *this;
+    }
+    StableStack(StableStack&& other) noexcept = default;
+    StableStack& operator=(StableStack&& other) noexcept = default;
 
     // Stack interface - state modifiers
-    void push() { current++; if (current == data.size()) data.emplace_back(); }
-    void pop() { current = std::max(current - 1, -1); }
-    void shrink() { current = 0; }      // Reduces (logically) the stack to only starting element
-    void clear() { current = -1; }      // Completely clears (logically) the stack
+    void push() { if (m_end == m_limit) [[unlikely]] reserve(2 * capacity()); m_end++; }
+    void pop() { m_end -= m_end != m_data.get(); }
+    void shrink() { m_end = m_data.get() + 1; }     // Reduces (logically) the stack to only starting element
+    void clear() { m_end = m_data.get(); }          // Completely clears (logically) the stack
+
+    // Capacity handling
+    // - Reallocates memory only if new capacity exceeds the current one
+    void reserve(std::size_t capacity) {
+        if (capacity <= this->capacity())
+            return;
+
+        std::unique_ptr<T[]> data = std::make_unique<T[]>(capacity);
+        std::size_t size = this->size();
+        std::move(m_data.get(), m_end, data.get());
+
+        m_data = std::move(data);
+        m_end = m_data.get() + size;
+        m_limit = m_data.get() + capacity;
+    }
 
     // Stack interface - getters
-    T& top() { return data[current]; }                              // Equivalent of top(0)
-    const T& top() const { return data[current]; }                  // Equivalent of top(0)
-    T& top_n(int n) { return data[current - n]; }                   // n-th element from the top
-    const T& top_n(int n) const { return data[current - n]; }       // n-th element from the top
-    size_t size() const { return size_t(current + 1); }
-    bool empty() const { return size() == -1; }
+    T& top() { return *(m_end - 1); }                               // Equivalent of top(0)
+    const T& top() const { return *(m_end - 1); }                   // Equivalent of top(0)
+    T& top_n(int n) { return *(m_end - 1 - n); }                    // n-th element from the top
+    const T& top_n(int n) const { return *(m_end - 1 - n); }        // n-th element from the top
+    std::size_t size() const { return std::size_t(m_end - m_data.get()); }
+    std::size_t capacity() const { return std::size_t(m_limit - m_data.get()); }
+    bool empty() const { return m_end == m_data.get(); }
 
 private:
-    // Data container
-    // - Array representation with std::vector is on average a little bit more efficient than double linked list representation
-    // - Since std::vector automatically resizes itself, we can use stack of any size
-    std::vector<T> data;
-
-    // Pointer - vector index
-    // - We assume that element with index -1 acts as null element (empty stack)
-    int current = -1;
-};
\ No newline at end of file
+    // Data container - preallocated arena
+    std::unique_ptr<T[]> m_data;
+
+    // Range pointers
+    // - m_end points right after the top element (empty stack has m_end equal to beginning of data)
+    // - m_limit points right after the last preallocated element
+    T* m_end;
+    T* m_limit;
+};
@@ -1,5 +1,7 @@
 #include "test.h"
 #include "../src/engine/board.h"
+#include "../src/engine/evalconfig.h"
+#include <chrono>
 #include <vector>
 
 
@@ -305,6 +307,41 @@ namespace Testing {
         return true;
     }
 
+    REGISTER_TEST(board_upcoming_repetition_test)
+    {
+        const std::string fen = "8/6bp/p5p1/1pk5/3p1P2/5KP1/P1P2B1P/8 w - - 0 35";
+
+        Board board;
+        board.load_position(fen);
+
+        board.make_move(Move(SQ_F3, SQ_E4, Moves::QUIET_MOVE_FLAG));
+        board.make_move(Move(SQ_C5, SQ_C6, Moves::QUIET_MOVE_FLAG));
+
+        ASSERT_EQUALS(false, board.upcoming_repetition(100));
+
+        // Kc6-c5 would repeat the starting position, but only if it's within the given range
+        board.make_move(Move(SQ_E4, SQ_F3, Moves::QUIET_MOVE_FLAG));
+
+        ASSERT_EQUALS(true, board.upcoming_repetition(100));
+        ASSERT_EQUALS(true, board.upcoming_repetition(4));
+        ASSERT_EQUALS(false, board.upcoming_repetition(3));
+
+        // Opponent's king did not come back, so there is no repetition available
+        board.undo_move();
+        board.make_move(Move(SQ_E4, SQ_D3, Moves::QUIET_MOVE_FLAG));
+
+        ASSERT_EQUALS(false, board.upcoming_repetition(100));
+
+        // Cycles can't go through null moves
+        board.undo_move();
+        board.make_move(Move(SQ_E4, SQ_F3, Moves::QUIET_MOVE_FLAG));
+        board.make_null_move();
+
+        ASSERT_EQUALS(false, board.upcoming_repetition(100));
+
+        return true;
+    }
+
 
     // -------------------------------------
     // Board test - threats calculation test
@@ -340,6 +377,58 @@ namespace Testing {
     }
 
 
+    // --------------------------------
+    // Board test - attack maps update
+    // --------------------------------
+
+    // Attack maps are updated incrementally from previous ply whenever it's possible
+    // - Reference board has no history (load_position() from other board), so it always calculates attack maps from scratch
+    REGISTER_TEST(board_attack_update_test)
+    {
+        Board board, reference;
+        board.load_position("r3k2r/1P3ppp/2n5/3pP1B1/1b6/2N2Q2/5PPP/R3K2R w KQkq d6 0 1");
+
+        // Castles, enpassant, promotion with capture, null move and captures of sliders
+        std::vector<Move> moves = {
+            Move(SQ_E5, SQ_D6, Moves::ENPASSANT_FLAG),
+            Move(SQ_E8, SQ_G8, Moves::KINGSIDE_CASTLE_FLAG),
+            Move(SQ_E1, SQ_C1, Moves::QUEENSIDE_CASTLE_FLAG),
+            Move(SQ_B4, SQ_C3, Moves::CAPTURE_FLAG),
+            Move(SQ_B7, SQ_A8, Moves::CAPTURE_FLAG | Moves::QUEEN_PROMOTION_FLAG),
+            Move(SQ_F8, SQ_A8, Moves::CAPTURE_FLAG),
+            Moves::null,
+            Move(SQ_C3, SQ_D2, Moves::QUIET_MOVE_FLAG),
+            Move(SQ_D1, SQ_D2, Moves::CAPTURE_FLAG),
+            Move(SQ_A8, SQ_A1, Moves::QUIET_MOVE_FLAG),
+        };
+
+        auto compare = [&]() {
+            reference.load_position(board);
+
+            for (Color side : { WHITE, BLACK })
+                for (PieceType ptype : { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING, ALL_PIECES })
+                    ASSERT_EQUALS(reference.attacks(side, ptype), board.attacks(side, ptype));
+
+            return true;
+        };
+
+        if (!compare())
+            return false;
+
+        for (const Move& move : moves) {
+            if (move == Moves::null)
+                board.make_null_move();
+            else
+                board.make_move(move);
+
+            if (!compare())
+                return false;
+        }
+
+        return true;
+    }
+
+
     // ------------------------------
     // Board test - zobrist hash test
     // ------------------------------
@@ -394,12 +483,183 @@ namespace Testing {
             zobrist.generate(board);
 
             ASSERT_EQUALS(zobrist.hash(), board.hash());
+            ASSERT_EQUALS(Zobrist::generate_pawn_hash(board), board.pawn_hash());
+        }
+
+        // Pawn hash must be restored after undoing moves
+        for (std::size_t i = 0; i < moves.size(); i++) {
+            board.undo_move();
+
+            ASSERT_EQUALS(Zobrist::generate_pawn_hash(board), board.pawn_hash());
+        }
+
+        return true;
+    }
+
+
+    // -------------------------
+    // Board test - material key
+    // -------------------------
+
+    // Similar to zobrist test - dynamically updated material key is compared with a key calculated from scratch
+    // - Material analysis is then verified on a few well known endgames
+    REGISTER_TEST(board_material_key_test)
+    {
+        Board board;
+        board.load_position("r3k3/1P6/7n/3pP3/8/8/8/4K2R w K d6 0 1");
+
+        auto generate_material_key = [](const Board& board) {
+            Evaluation::MaterialKey key = 0;
+            for (uint32_t sq = SQ_A1; sq <= SQ_H8; sq++)
+                key += Evaluation::material_key(board.on(Square(sq)));
+            return key;
+        };
+
+        // Enpassant, capture with promotion and normal capture
+        std::vector<Move> moves = {
+            Move(SQ_E5, SQ_D6, Moves::ENPASSANT_FLAG),
+            Move(SQ_E8, SQ_F7, Moves::QUIET_MOVE_FLAG),
+            Move(SQ_B7, SQ_A8, Moves::CAPTURE_FLAG | Moves::QUEEN_PROMOTION_FLAG),
+            Move(SQ_F7, SQ_E6, Moves::QUIET_MOVE_FLAG),
+            Move(SQ_H1, SQ_H6, Moves::CAPTURE_FLAG)
+        };
+
+        ASSERT_EQUALS(generate_material_key(board), board.material_key());
+
+        for (const Move& move : moves) {
+            board.make_move(move);
+            ASSERT_EQUALS(generate_material_key(board), board.material_key());
         }
 
+        // KQR vs K - lone king mate for white
+        Evaluation::MaterialEntry entry = Evaluation::analyze_material(board.material_key());
+        ASSERT_EQUALS(Evaluation::LONE_KING_MATE, entry.endgame_eval);
+        ASSERT_EQUALS(WHITE, entry.strong_side);
+        ASSERT_EQUALS(false, entry.insufficient_material);
+        ASSERT_EQUALS((Evaluation::GameStage::PieceWeights[QUEEN] + Evaluation::GameStage::PieceWeights[ROOK]), entry.game_stage);
+
+        for (std::size_t i = 0; i < moves.size(); i++)
+            board.undo_move();
+
+        ASSERT_EQUALS(generate_material_key(board), board.material_key());
+
+        // KN vs K - insufficient material, no mating material
+        board.load_position("8/8/4k3/8/8/2N5/8/4K3 w - - 0 1");
+        entry = Evaluation::analyze_material(board.material_key());
+        ASSERT_EQUALS(Evaluation::NO_ENDGAME_EVAL, entry.endgame_eval);
+        ASSERT_EQUALS(true, entry.insufficient_material);
+
+        // KBN vs K - black has mating material
+        board.load_position("8/8/4k3/3bn3/8/8/8/4K3 w - - 0 1");
+        entry = Evaluation::analyze_material(board.material_key());
+        ASSERT_EQUALS(Evaluation::LONE_KING_MATE, entry.endgame_eval);
+        ASSERT_EQUALS(BLACK, entry.strong_side);
+        ASSERT_EQUALS(false, entry.insufficient_material);
+
         return true;
     }
 
 
+    // ----------------------------
+    // Board test - packed position
+    // ----------------------------
+
+    // Positions loaded from binary encoding must be exactly the same as the ones loaded from FEN
+    REGISTER_TEST(board_packed_position_test)
+    {
+        const std::string positions[] = {
+            Chessboard::STARTING_POSITION,
+            "r2qkb1r/1p4pp/2n1b1p1/pBP1Pp2/1P5R/n3PNP1/P2N1B1P/R1Q1K3 w Qkq f6 0 7",
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R b KQkq - 13 42",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 99 120",
+        };
+
+        for (const std::string& fen : positions) {
+            Board board, decoded;
+            board.load_position(fen);
+            decoded.load_position(board.encode());
+
+            ASSERT_EQUALS(board, decoded);
+            ASSERT_EQUALS(board.fen(), decoded.fen());
+            ASSERT_EQUALS(board.hash(), decoded.hash());
+            ASSERT_EQUALS(board.pawn_hash(), decoded.pawn_hash());
+            ASSERT_EQUALS(board.material_key(), decoded.material_key());
+        }
+
+        // Helper function - checks whether given operation is rejected
+        auto rejects = [](auto&& operation) {
+            try {
+                operation();
+            }
+            catch (const std::invalid_argument&) {
+                return true;
+            }
+
+            return false;
+        };
+
+        // Positions which do not fit into the encoding must be rejected, and failed decoding must keep the current position
+        Board board, decoded;
+        board.load_position("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+        Chessboard::PackedPosition packed = board.encode();
+        Chessboard::PackedPosition invalid = packed;
+        invalid.pieces[0] = 0x27;           // Invalid piece code on A1
+        Chessboard::PackedPosition kingless = packed;
+        kingless.pieces[2] = 0x33;          // White king on E1 replaced by a bishop
+
+        board.load_position("rnbqkbnr/pppppppp/pppppppp/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+        ASSERT_EQUALS(true, rejects([&]() { board.encode(); }));
+
+        decoded.load_position(Chessboard::STARTING_POSITION);
+        ASSERT_EQUALS(true, rejects([&]() { decoded.load_position(invalid); }));
+        ASSERT_EQUALS(true, rejects([&]() { decoded.load_position(kingless); }));
+
+        packed.occupancy |= Chessboard::RANK_3;
+        ASSERT_EQUALS(true, rejects([&]() { decoded.load_position(packed); }));
+        ASSERT_EQUALS(Chessboard::STARTING_POSITION, decoded.fen());
+
+        return true;
+    }
+
+    // Measures encoding and decoding throughput
+    void board_packing_speed_test(uint32_t repetitions)
+    {
+        const std::string positions[] = {
+            Chessboard::STARTING_POSITION,
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        };
+
+        for (const std::string& fen : positions) {
+            Board board;
+            board.load_position(fen);
+
+            // Checksum prevents compiler from optimizing the loops away
+            uint64_t checksum = 0;
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < repetitions; i++)
+                checksum += board.encode().pieces[i % 16];
+            auto middle = std::chrono::steady_clock::now();
+
+            Chessboard::PackedPosition packed = board.encode();
+            for (uint32_t i = 0; i < repetitions; i++) {
+                packed.halfmove_clock = uint8_t(i % 100);
+                board.load_position(packed);
+                checksum += board.hash();
+            }
+            auto end = std::chrono::steady_clock::now();
+
+            std::chrono::duration<double> encode_time = middle - start;
+            std::chrono::duration<double> decode_time = end - middle;
+
+            std::cout << "----- Packing: " << fen << " (checksum " << checksum << ") -----\n";
+            std::cout << "> Encode: " << uint64_t(repetitions / encode_time.count()) << " positions/s\n";
+            std::cout << "> Decode: " << uint64_t(repetitions / decode_time.count()) << " positions/s\n";
+        }
+    }
+
+
     // --------------------------------------
     // Board test - move legality checks test
     // --------------------------------------
@@ -1,5 +1,13 @@
 #include "test.h"
+#include "../src/engine/engine.h"
+#include "../src/engine/eval.h"
+#include "../src/engine/movegen.h"
 #include "../src/engine/nnue.h"
+#include "../src/engine/randomgen.h"
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <memory>
 #include <vector>
 
@@ -121,4 +129,374 @@ namespace Testing {
         return true;
     }
 
+    // This test focuses on the accumulator stack being deep enough to cover the longest possible search line
+    REGISTER_TEST(nnue_max_depth_test)
+    {
+        Board board;
+        std::unique_ptr<Evaluation::NNUE> nnue = std::make_unique<Evaluation::NNUE>();
+        std::unique_ptr<Evaluation::NNUE> reference = std::make_unique<Evaluation::NNUE>();
+
+        // Load network parameters
+        nnue->load("model/model_best.nnue");
+        reference->load("model/model_best.nnue");
+
+        board.load_position("r1bqkb1r/pppp1ppp/2n2n2/4p3/4P3/2N2N2/PPPP1PPP/R1BQKB1R w KQkq - 4 4");
+        nnue->set(board);
+
+        // Shuffle knights back and forth until the deepest ply a crawler can reach (search + quiescence)
+        const Move shuffle[4] = { Move(SQ_F3, SQ_G1, Moves::QUIET_MOVE_FLAG), Move(SQ_F6, SQ_G8, Moves::QUIET_MOVE_FLAG),
+                                  Move(SQ_G1, SQ_F3, Moves::QUIET_MOVE_FLAG), Move(SQ_G8, SQ_F6, Moves::QUIET_MOVE_FLAG) };
+
+        for (int i = 0; i < MAX_TOTAL_SEARCH_DEPTH; i++) {
+            nnue->update(board, shuffle[i % 4]);
+            board.make_move(shuffle[i % 4]);
+        }
+
+        // Lazily updated accumulators at the deepest ply must match the ones calculated from scratch
+        reference->set(board);
+
+        ASSERT_EQUALS(reference->forward(board), nnue->forward(board));
+
+        return true;
+    }
+
+    // This test focuses on batch forward pass giving exactly the same results as set() followed by forward()
+    REGISTER_TEST(nnue_batch_forward_test)
+    {
+        std::unique_ptr<Evaluation::NNUE> nnue = std::make_unique<Evaluation::NNUE>();
+
+        // Load network parameters
+        nnue->load("model/model_best.nnue");
+
+        std::vector<std::pair<std::string, int>> positions = {
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 14},
+            {"8/1p4p1/2p1k2p/4b3/P3Kp1P/1P6/2PB2P1/8 b - - 1 33", -66},
+            {"3rnrk1/1pp1bppp/2qp4/4P3/5B2/1QN5/PPP2PPP/R2R2K1 w - - 5 16", 188},
+            {"r3kbnr/pppq1ppp/3p4/8/3QP3/2N5/PPP2PPP/R1B1K2R b KQkq - 0 8", -32},
+            {"r1bq1rk1/1pp2p2/pn2p2p/n3P3/PbpPN3/5N2/1PQ1BPPP/R2R2K1 w - - 0 14", 59}
+        };
+
+        // Repeat positions enough times to fill a few chunks and leave an incomplete one at the end
+        std::vector<Board> boards(3 * Evaluation::BATCH_CHUNK_SIZE + 3);
+        for (std::size_t i = 0; i < boards.size(); i++)
+            boards[i].load_position(positions[i % positions.size()].first);
+
+        for (unsigned threads : {1, 3}) {
+            std::vector<int32_t> results(boards.size(), 0);
+            nnue->forward(boards, results, threads);
+
+            for (std::size_t i = 0; i < boards.size(); i++)
+                ASSERT_EQUALS(positions[i % positions.size()].second, results[i]);
+        }
+
+        return true;
+    }
+
+
+    // This test focuses on conversion into INT8 quantization and correctness of INT8 dynamic updates
+    REGISTER_TEST(nnue_int8_quantization_test)
+    {
+        Board board;
+        std::unique_ptr<Evaluation::NNUE> nnue = std::make_unique<Evaluation::NNUE>();
+        std::unique_ptr<Evaluation::NNUE> nnue_int8 = std::make_unique<Evaluation::NNUE>();
+
+        // Convert network parameters into INT8 file and load it
+        std::string filepath = (std::filesystem::temp_directory_path() / "lazarus_int8_test.nnue").string();
+
+        nnue->load("model/model_best.nnue");
+        nnue->save(filepath, Evaluation::Quantization::INT8);
+        nnue_int8->load(filepath);
+
+        ASSERT_EQUALS(true, (nnue->quantization() == Evaluation::Quantization::INT16));
+        ASSERT_EQUALS(true, (nnue_int8->quantization() == Evaluation::Quantization::INT8));
+
+        // Only weights of the loaded quantization should be kept in memory
+        ASSERT_EQUALS(true, (nnue->weights()->accumulator_weights_int8 == nullptr));
+        ASSERT_EQUALS(true, (nnue_int8->weights()->accumulator_weights == nullptr));
+
+        // INT8 network should give approximately the same evaluations
+        board.load_position("r3kbnr/pppq1ppp/2npb3/1B2p3/4P3/2NP1N2/PPP2PPP/R1BQK2R w KQkq - 3 6");
+        nnue->set(board);
+        nnue_int8->set(board);
+
+        ASSERT_EQUALS(true, (std::abs(nnue->forward(board) - nnue_int8->forward(board)) <= 25));
+
+        // Dynamic updates of INT8 network should match static ones
+        std::unique_ptr<Evaluation::NNUE> reference = std::make_unique<Evaluation::NNUE>();
+        reference->load(filepath);
+
+        std::filesystem::remove(filepath);
+
+        const Move moves[4] = { Move(SQ_E1, SQ_G1, Moves::KINGSIDE_CASTLE_FLAG), Move(SQ_E8, SQ_C8, Moves::QUEENSIDE_CASTLE_FLAG),
+                                Move(SQ_B5, SQ_C6, Moves::CAPTURE_FLAG), Move(SQ_D7, SQ_C6, Moves::CAPTURE_FLAG) };
+
+        for (const Move& move : moves) {
+            nnue_int8->update(board, move);
+            board.make_move(move);
+        }
+
+        reference->set(board);
+
+        ASSERT_EQUALS(reference->forward(board), nnue_int8->forward(board));
+
+        return true;
+    }
+
+    // This test focuses on network file validation - header, architecture and hash
+    REGISTER_TEST(nnue_file_format_test)
+    {
+        Board board;
+        std::unique_ptr<Evaluation::NNUE> nnue = std::make_unique<Evaluation::NNUE>();
+        std::unique_ptr<Evaluation::NNUE> reloaded = std::make_unique<Evaluation::NNUE>();
+
+        // Helper function - checks whether loading given file is rejected
+        auto rejects = [](auto& network, const std::string& filepath) {
+            try {
+                network.load(filepath);
+            }
+            catch (const std::invalid_argument&) {
+                return true;
+            }
+
+            return false;
+        };
+
+        // Saved network should load back with exactly the same parameters
+        std::string filepath = (std::filesystem::temp_directory_path() / "lazarus_format_test.nnue").string();
+
+        nnue->load("model/model_best.nnue");
+        nnue->save(filepath, Evaluation::Quantization::INT16);
+        reloaded->load(filepath);
+
+        board.load_position("r3kbnr/pppq1ppp/2npb3/1B2p3/4P3/2NP1N2/PPP2PPP/R1BQK2R w KQkq - 3 6");
+        nnue->set(board);
+        reloaded->set(board);
+
+        ASSERT_EQUALS(nnue->forward(board), reloaded->forward(board));
+
+        // Network of different size must be rejected
+        std::unique_ptr<Evaluation::Network<256>> small = std::make_unique<Evaluation::Network<256>>();
+
+        ASSERT_EQUALS(true, rejects(*small, filepath));
+        ASSERT_EQUALS(true, rejects(*small, "model/model_best.nnue"));
+
+        // Smaller networks use the same file format
+        std::string small_filepath = (std::filesystem::temp_directory_path() / "lazarus_format_test_256.nnue").string();
+
+        small->save(small_filepath, Evaluation::Quantization::INT8);
+        ASSERT_EQUALS(false, rejects(*small, small_filepath));
+        ASSERT_EQUALS(true, rejects(*nnue, small_filepath));
+        ASSERT_EQUALS(true, (small->quantization() == Evaluation::Quantization::INT8));
+
+        std::filesystem::remove(small_filepath);
+
+        // Corrupted parameters must be detected
+        {
+            std::fstream file(filepath, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(sizeof(Evaluation::NetworkHeader) + 1000);
+            file.put(char(0x55));
+        }
+
+        ASSERT_EQUALS(true, rejects(*reloaded, filepath));
+
+        // Truncated file must be detected
+        std::filesystem::resize_file(filepath, std::filesystem::file_size(filepath) - 1);
+
+        ASSERT_EQUALS(true, rejects(*reloaded, filepath));
+
+        std::filesystem::remove(filepath);
+
+        return true;
+    }
+
+    // This test focuses on replacing engine's network between searches
+    REGISTER_TEST(nnue_hot_swap_test)
+    {
+        std::unique_ptr<Engine> engine = std::make_unique<Engine>(Engine::Mode::STANDARD);
+        std::unique_ptr<Engine> reference = nullptr;
+        std::unique_ptr<Evaluation::NNUE> nnue = std::make_unique<Evaluation::NNUE>();
+
+        std::string filepath = (std::filesystem::temp_directory_path() / "lazarus_hot_swap_test.nnue").string();
+
+        nnue->load("model/model_best.nnue");
+        nnue->save(filepath, Evaluation::Quantization::INT8);
+
+        // Search some position to fill transposition table
+        std::vector<Board> boards(1);
+        boards[0].load_position("r3kbnr/pppq1ppp/2npb3/1B2p3/4P3/2NP1N2/PPP2PPP/R1BQK2R w KQkq - 3 6");
+        engine->set_position(boards[0]);
+        engine->evaluate(4);
+
+        ASSERT_EQUALS(true, (engine->ttable()->probe(boards[0].hash(), boards[0].pieces()) != nullptr));
+
+        // Swap network - transposition table must stay intact
+        engine->load_network(filepath);
+
+        ASSERT_EQUALS(true, engine->update_network(true));
+        ASSERT_EQUALS(filepath, engine->network().filepath);
+        ASSERT_EQUALS(false, engine->update_network(true));
+        ASSERT_EQUALS(true, (engine->ttable()->probe(boards[0].hash(), boards[0].pieces()) != nullptr));
+
+        // Swapped network should evaluate exactly like the freshly loaded one
+        Search::Score result = 0, expected = 0;
+        reference = std::make_unique<Engine>(Engine::Mode::STANDARD, filepath);
+        engine->evaluate(boards, std::span<Search::Score>(&result, 1));
+        reference->evaluate(boards, std::span<Search::Score>(&expected, 1));
+
+        ASSERT_EQUALS(expected, result);
+
+        std::filesystem::remove(filepath);
+
+        // Failed load must keep the current network
+        bool rejected = false;
+        engine->load_network(filepath);
+
+        try {
+            engine->update_network(true);
+        }
+        catch (const std::invalid_argument&) {
+            rejected = true;
+        }
+
+        ASSERT_EQUALS(true, rejected);
+        ASSERT_EQUALS(filepath, engine->network().filepath);
+        ASSERT_EQUALS(false, engine->network_error().empty());
+
+        engine->evaluate(boards, std::span<Search::Score>(&result, 1));
+
+        ASSERT_EQUALS(expected, result);
+
+        // Search must not throw when the pending load has failed
+        rejected = false;
+        engine->load_network(filepath);
+
+        try {
+            engine->evaluate(2);
+        }
+        catch (const std::exception&) {
+            rejected = true;
+        }
+
+        ASSERT_EQUALS(false, rejected);
+        ASSERT_EQUALS(filepath, engine->network().filepath);
+        ASSERT_EQUALS(false, engine->network_error().empty());
+
+        return true;
+    }
+
+    // ------------------------------------------
+    // Special tests - batch evaluation benchmark
+    // ------------------------------------------
+
+    // This test measures NNUE evaluation throughput (positions per second)
+    // - Compares evaluating positions one at a time (set() + evaluate()) with batch evaluation on given number of threads
+    // - Positions are obtained by random playouts from the starting position
+    void nnue_batch_speed_test(unsigned no_positions, unsigned threads)
+    {
+        std::unique_ptr<Evaluation::NNUE> nnue = std::make_unique<Evaluation::NNUE>();
+        nnue->load("model/model_best.nnue");
+
+        // Generate positions
+        Random::StandardGenerator<uint64_t> generator(2137);
+        std::vector<Board> boards(no_positions);
+
+        for (Board& board : boards) {
+            unsigned length = unsigned(generator.random() % 80);
+
+            for (unsigned ply = 0; ply < length; ply++) {
+                Moves::List<Move> movelist;
+                MoveGeneration::generate_moves<MoveGeneration::LEGAL>(board, movelist);
+
+                if (movelist.empty())
+                    break;
+
+                board.make_move(movelist[int(generator.random() % movelist.size())]);
+            }
+        }
+
+        std::vector<Eval> results(no_positions);
+
+        // Measures throughput of given evaluation method
+        auto measure = [no_positions](const std::string& name, auto&& method) {
+            auto start = std::chrono::steady_clock::now();
+            method();
+            auto end = std::chrono::steady_clock::now();
+
+            std::chrono::duration<double> time = end - start;
+
+            std::cout << std::dec << "> " << name << ": " << (long long)(no_positions / time.count()) << " positions/s\n";
+        };
+
+        std::cout << "----- NNUE evaluation throughput (" << no_positions << " positions) -----\n";
+        measure("One at a time", [&]() {
+            for (unsigned i = 0; i < no_positions; i++) {
+                nnue->set(boards[i]);
+                results[i] = Evaluation::evaluate(boards[i], *nnue);
+            }
+        });
+        measure("Batch, 1 thread", [&]() { Evaluation::evaluate(boards, results, *nnue, 1); });
+        measure("Batch, " + std::to_string(threads) + " threads", [&]() { Evaluation::evaluate(boards, results, *nnue, threads); });
+    }
+
+
+    // ------------------------------------------
+    // Special tests - quantization comparison
+    // ------------------------------------------
+
+    // This test compares INT8 network with the original INT16 one
+    // - Static evaluation difference is measured on all positions from given test data file
+    // - Search accuracy and speed are measured with the usual search tests
+    void nnue_quantization_test(int8_t depth, std::string input)
+    {
+        // Convert network parameters into INT8 file
+        std::string network_int8 = (std::filesystem::temp_directory_path() / "lazarus_int8.nnue").string();
+
+        std::unique_ptr<Evaluation::NNUE> nnue = std::make_unique<Evaluation::NNUE>();
+        std::unique_ptr<Evaluation::NNUE> nnue_int8 = std::make_unique<Evaluation::NNUE>();
+
+        nnue->load(Evaluation::DEFAULT_NETWORK);
+        nnue->save(network_int8, Evaluation::Quantization::INT8);
+        nnue_int8->load(network_int8);
+
+        // Static evaluation comparison
+        // - Test data file contains position FEN after the number of acceptable moves, followed by the list of those moves
+        std::ifstream input_file(input);
+        Board board;
+
+        unsigned no_positions = 0;
+        long long total_diff = 0, max_diff = 0;
+
+        unsigned no_moves;
+        while (input_file >> no_moves) {
+            std::string fen, line;
+            input_file.get();
+            std::getline(input_file, fen);
+            for (unsigned i = 0; i < no_moves; i++)
+                std::getline(input_file, line);
+
+            board.load_position(fen);
+            nnue->set(board);
+            nnue_int8->set(board);
+
+            long long diff = std::abs(nnue->forward(board) - nnue_int8->forward(board));
+
+            no_positions++;
+            total_diff += diff;
+            max_diff = std::max(max_diff, diff);
+        }
+
+        std::cout << "----- INT8 vs INT16 static evaluation (" << no_positions << " positions) -----\n";
+        std::cout << std::dec << "> Mean absolute difference: " << double(total_diff) / std::max(no_positions, 1U) << " cp\n";
+        std::cout << "> Max absolute difference: " << max_diff << " cp\n\n";
+
+        // Search comparison
+        for (auto [name, network] : { std::make_pair("INT16", Evaluation::DEFAULT_NETWORK), std::make_pair("INT8", network_int8) }) {
+            std::cout << "========== " << name << " network ==========\n";
+            search_accuracy_test(depth, input, network);
+            search_speed_test(depth, network);
+        }
+
+        std::filesystem::remove(network_int8);
+    }
+
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "test.h"
 #include "../src/engine/movegen.h"
 #include <algorithm>
+#include <chrono>
 
 
 namespace Testing {
@@ -152,4 +153,307 @@ namespace Testing {
                                 6, {11030083, 940350, 33325, 0, 7552});
     }
 
-}
\ No newline at end of file
+
+    // ---------------------------
+    // Legal move generation tests
+    // ---------------------------
+
+    // Helper function - compares legal generation of given mode with pseudo legal generation filtered by board.is_legal_p()
+    template <MoveGeneration::Mode mode>
+    bool compare_legal_generation(const Board& board)
+    {
+        Moves::List<Move> expected, result;
+
+        MoveGeneration::generate_moves<mode>(board, expected);
+        expected.set_end(std::partition(expected.begin(), expected.end(), [&board](const Move& move) { return board.is_legal_p(move); }));
+        MoveGeneration::generate_legal_moves<mode>(board, result);
+
+        std::sort(expected.begin(), expected.end(), [](const Move& a, const Move& b) { return a.raw() < b.raw(); });
+        std::sort(result.begin(), result.end(), [](const Move& a, const Move& b) { return a.raw() < b.raw(); });
+
+        return expected.size() == result.size() && std::equal(expected.begin(), expected.end(), result.begin());
+    }
+
+    // Helper function - runs the above comparison for every position in the tree of given depth
+    bool test_legal_generation(Board& board, uint32_t depth)
+    {
+        if (board.in_check()) {
+            ASSERT_EQUALS(true, compare_legal_generation<MoveGeneration::CHECK_EVASION>(board));
+        }
+        else {
+            ASSERT_EQUALS(true, compare_legal_generation<MoveGeneration::PSEUDO_LEGAL>(board));
+            ASSERT_EQUALS(true, compare_legal_generation<MoveGeneration::CAPTURE>(board));
+            ASSERT_EQUALS(true, compare_legal_generation<MoveGeneration::QUIET_CHECK>(board));
+            ASSERT_EQUALS(true, compare_legal_generation<MoveGeneration::QUIET>(board));
+        }
+
+        if (depth == 0)
+            return true;
+
+        Moves::List<Move> movelist;
+        MoveGeneration::generate_moves<MoveGeneration::LEGAL>(board, movelist);
+
+        for (const Move& move : movelist) {
+            board.make_move(move);
+            bool result = test_legal_generation(board, depth - 1);
+            board.undo_move();
+
+            if (!result)
+                return false;
+        }
+
+        return true;
+    }
+
+    // Test 5 - legal generation in each mode (pins, discovered enpassant, castling through attacks, evasions)
+    REGISTER_TEST(movegen_legal_modes_test)
+    {
+        const std::string positions[] = {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+            "8/8/8/KPp4r/8/8/8/7k w - c6 0 2",
+        };
+
+        for (const std::string& fen : positions) {
+            Board board;
+            board.load_position(fen);
+
+            if (!test_legal_generation(board, 3))
+                return false;
+        }
+
+        return true;
+    }
+
+
+    // -----------------------------------------
+    // Special tests - move generation benchmark
+    // -----------------------------------------
+
+    // Helper function - perft with pseudo legal generation followed by legality check of each move
+    uint64_t perft_pseudo_legal(Board& board, uint32_t depth)
+    {
+        Moves::List<Move> movelist;
+
+        if (board.in_check())
+            MoveGeneration::generate_moves<MoveGeneration::CHECK_EVASION>(board, movelist);
+        else
+            MoveGeneration::generate_moves<MoveGeneration::PSEUDO_LEGAL>(board, movelist);
+
+        uint64_t nodes = 0;
+
+        for (const Move& move : movelist) {
+            if (!board.is_legal_p(move))
+                continue;
+
+            if (depth == 1)
+                nodes++;
+            else {
+                board.make_move(move);
+                nodes += perft_pseudo_legal(board, depth - 1);
+                board.undo_move();
+            }
+        }
+
+        return nodes;
+    }
+
+    // Helper function - perft with legal generation
+    uint64_t perft_legal(Board& board, uint32_t depth)
+    {
+        Moves::List<Move> movelist;
+        MoveGeneration::generate_moves<MoveGeneration::LEGAL>(board, movelist);
+
+        if (depth == 1)
+            return movelist.size();
+
+        uint64_t nodes = 0;
+
+        for (const Move& move : movelist) {
+            board.make_move(move);
+            nodes += perft_legal(board, depth - 1);
+            board.undo_move();
+        }
+
+        return nodes;
+    }
+
+    // Helper function - perft with legal generation, which also makes & unmakes moves at the last ply (no bulk counting)
+    // - Measures make & unmake throughput together with move generation
+    uint64_t perft_make_unmake(Board& board, uint32_t depth)
+    {
+        if (depth == 0)
+            return 1;
+
+        Moves::List<Move> movelist;
+        MoveGeneration::generate_moves<MoveGeneration::LEGAL>(board, movelist);
+
+        uint64_t nodes = 0;
+
+        for (const Move& move : movelist) {
+            board.make_move(move);
+            nodes += perft_make_unmake(board, depth - 1);
+            board.undo_move();
+        }
+
+        return nodes;
+    }
+
+    // Helper function - perft with legal generation and copy-make instead of make & unmake
+    // - Scratch board is used only for move generation, positions are passed down as compact states
+    uint64_t perft_copy_make(const Chessboard::BoardState& state, uint32_t depth)
+    {
+        if (depth == 0)
+            return 1;
+
+        static Board board;
+        board.load_position(state);
+
+        Moves::List<Move> movelist;
+        MoveGeneration::generate_moves<MoveGeneration::LEGAL>(board, movelist);
+
+        uint64_t nodes = 0;
+
+        for (const Move& move : movelist)
+            nodes += perft_copy_make(Chessboard::make_move(state, move), depth - 1);
+
+        return nodes;
+    }
+
+    // Copy-make must produce exactly the same positions as make & unmake
+    REGISTER_TEST(movegen_copy_make_test)
+    {
+        const std::string positions[] = {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        };
+
+        // Compares all the logical aspects of a board with a state (comparision of boards covers pieces, checks & special aspects)
+        auto matches = [](const Board& board, const Chessboard::BoardState& state) -> bool {
+            Board reference;
+            reference.load_position(state);
+
+            ASSERT_EQUALS(board, reference);
+            ASSERT_EQUALS(board.hash(), reference.hash());
+            ASSERT_EQUALS(board.pawn_hash(), reference.pawn_hash());
+            ASSERT_EQUALS(board.material_key(), reference.material_key());
+            ASSERT_EQUALS(board.halfmoves_c(), reference.halfmoves_c());
+            ASSERT_EQUALS(board.halfmoves_p(), reference.halfmoves_p());
+
+            return true;
+        };
+
+        for (const std::string& fen : positions) {
+            Board board;
+            board.load_position(fen);
+
+            // Two plies - compare with regular move maker, where the second ply is made from a copy-made state
+            Moves::List<Move> movelist;
+            MoveGeneration::generate_moves<MoveGeneration::LEGAL>(board, movelist);
+
+            for (const Move& move : movelist) {
+                Chessboard::BoardState state = Chessboard::make_move(board.state(), move);
+                board.make_move(move);
+                ASSERT_EQUALS(true, matches(board, state));
+
+                Moves::List<Move> replies;
+                MoveGeneration::generate_moves<MoveGeneration::LEGAL>(board, replies);
+
+                for (const Move& reply : replies) {
+                    Chessboard::BoardState reply_state = Chessboard::make_move(state, reply);
+                    board.make_move(reply);
+                    ASSERT_EQUALS(true, matches(board, reply_state));
+                    board.undo_move();
+                }
+
+                board.undo_move();
+            }
+
+            // Whole tree - compare node counts
+            ASSERT_EQUALS(perft_make_unmake(board, 3), perft_copy_make(board.state(), 3));
+        }
+
+        return true;
+    }
+
+    // Validation of stored moves (transposition table moves, killers) must accept exactly the generated legal moves
+    // - Every from-to pair of non-pawn pieces is tested both as a quiet move and as a capture
+    REGISTER_TEST(movegen_stored_move_validation_test)
+    {
+        const std::string positions[] = {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+            "4k3/8/8/8/1b6/8/3N4/4K2R w K - 0 1",
+        };
+
+        for (const std::string& fen : positions) {
+            Board board;
+            board.load_position(fen);
+
+            Moves::List<Move> movelist;
+            MoveGeneration::generate_moves<MoveGeneration::LEGAL>(board, movelist);
+
+            for (uint32_t from = 0; from < SQUARE_RANGE; from++) {
+                if (type_of(board.on(Square(from))) == PAWN)
+                    continue;
+
+                for (uint32_t to = 0; to < SQUARE_RANGE; to++) {
+                    for (Moves::Flags flags : { Moves::QUIET_MOVE_FLAG, Moves::CAPTURE_FLAG }) {
+                        Move move(Square(from), Square(to), flags);
+                        bool generated = std::find(movelist.begin(), movelist.end(), move) != movelist.end();
+
+                        ASSERT_EQUALS(generated, board.is_legal_f(move));
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // This test compares perft speed of pseudo legal generation (+ is_legal_p() for each move) and legal generation
+    // - Additionally, it measures legal perft with make & unmake of every move (including the last ply), and the same perft with copy-make
+    void movegen_perft_speed_test(uint32_t depth)
+    {
+        const std::string positions[] = {
+            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        };
+
+        for (const std::string& fen : positions) {
+            Board board;
+            board.load_position(fen);
+
+            auto start = std::chrono::steady_clock::now();
+            uint64_t pseudo_legal_nodes = perft_pseudo_legal(board, depth);
+            auto middle = std::chrono::steady_clock::now();
+            uint64_t legal_nodes = perft_legal(board, depth);
+            auto end = std::chrono::steady_clock::now();
+            uint64_t make_unmake_nodes = perft_make_unmake(board, depth);
+            auto make_unmake_end = std::chrono::steady_clock::now();
+            uint64_t copy_make_nodes = perft_copy_make(board.state(), depth);
+            auto copy_make_end = std::chrono::steady_clock::now();
+
+            std::chrono::duration<double> pseudo_legal_time = middle - start;
+            std::chrono::duration<double> legal_time = end - middle;
+            std::chrono::duration<double> make_unmake_time = make_unmake_end - end;
+            std::chrono::duration<double> copy_make_time = copy_make_end - make_unmake_end;
+
+            std::cout << "----- Perft " << depth << ": " << fen << " -----\n";
+            std::cout << "> Pseudo legal + is_legal_p(): " << pseudo_legal_nodes << " nodes, " << pseudo_legal_time.count() << " s, "
+                      << uint64_t(pseudo_legal_nodes / pseudo_legal_time.count()) << " nodes/s\n";
+            std::cout << "> Legal: " << legal_nodes << " nodes, " << legal_time.count() << " s, "
+                      << uint64_t(legal_nodes / legal_time.count()) << " nodes/s\n";
+            std::cout << "> Legal with make & unmake: " << make_unmake_nodes << " nodes, " << make_unmake_time.count() << " s, "
+                      << uint64_t(make_unmake_nodes / make_unmake_time.count()) << " nodes/s\n";
+            std::cout << "> Legal with copy-make: " << copy_make_nodes << " nodes, " << copy_make_time.count() << " s, "
+                      << uint64_t(copy_make_nodes / copy_make_time.count()) << " nodes/s\n";
+        }
+    }
+
+}
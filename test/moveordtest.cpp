@@ -1,6 +1,9 @@
 #include "test.h"
+#include "../src/engine/history.h"
 #include "../src/engine/moveord.h"
 
+#include <chrono>
+
 
 namespace Testing {
 
@@ -15,40 +18,42 @@ namespace Testing {
         board.load_position("2r2r2/p1q1nk1p/bpp2pp1/8/4P1N1/1NQ5/PP3PPP/3RR1K1 w - - 2 22");
 
         MoveOrdering::Selector selector(&board, MoveGeneration::CAPTURE);
-        selector.strategy.add_rule(MoveGeneration::CAPTURE, [&board](const EMove& move) -> bool {
-            return type_of(board.on(move.from())) == QUEEN && file_of(move.to()) == FILE_F;
-        });
-        selector.strategy.add_rule(MoveGeneration::CAPTURE, [&board](const EMove& move) -> bool {
-            return type_of(board.on(move.from())) == QUEEN;
-        });
-        selector.strategy.add_rule(MoveGeneration::QUIET_CHECK, [&board](const EMove& move) -> bool {
-            return board.see(move) >= 0;
-        });
-        selector.strategy.add_rule(MoveGeneration::QUIET, [&board](const EMove& move) -> bool {
-            return move.is_double_pawn_push();
-        });
+        MoveOrdering::Strategy strategy(
+            MoveOrdering::make_rule<MoveGeneration::CAPTURE>([&board](const EMove& move) -> bool {
+                return type_of(board.on(move.from())) == QUEEN && file_of(move.to()) == FILE_F;
+            }),
+            MoveOrdering::make_rule<MoveGeneration::CAPTURE>([&board](const EMove& move) -> bool {
+                return type_of(board.on(move.from())) == QUEEN;
+            }),
+            MoveOrdering::make_rule<MoveGeneration::QUIET_CHECK>([&board](const EMove& move) -> bool {
+                return board.see(move) >= 0;
+            }),
+            MoveOrdering::make_rule<MoveGeneration::QUIET>([](const EMove& move) -> bool {
+                return move.is_double_pawn_push();
+            })
+        );
 
         // has_next() is called after every next() invocation to test whether it is safe to use in between other Selector operations
-        ASSERT_EQUALS(true, selector.has_next());
-        ASSERT_EQUALS(Move(SQ_C3, SQ_F6, Moves::CAPTURE_FLAG), selector.next());
-        ASSERT_EQUALS(true, selector.has_next());
-        ASSERT_EQUALS(Move(SQ_C3, SQ_C6, Moves::CAPTURE_FLAG), selector.next());
-        ASSERT_EQUALS(true, selector.has_next());
-        ASSERT_EQUALS(Move(SQ_G4, SQ_F6, Moves::CAPTURE_FLAG), selector.next());
-        ASSERT_EQUALS(true, selector.has_next());
-        ASSERT_EQUALS(Move(SQ_G4, SQ_H6, Moves::QUIET_MOVE_FLAG), selector.next());
-        ASSERT_EQUALS(true, selector.has_next());
-        ASSERT_EQUALS(Move(SQ_G4, SQ_E5, Moves::QUIET_MOVE_FLAG), selector.next());
-        ASSERT_EQUALS(true, selector.has_next());
-        ASSERT_EQUALS(Move(SQ_C3, SQ_C4, Moves::QUIET_MOVE_FLAG), selector.next());
-        ASSERT_EQUALS(true, selector.has_next());
-        ASSERT_EQUALS(Move(SQ_A2, SQ_A4, Moves::DOUBLE_PAWN_PUSH_FLAG), selector.next());
-        ASSERT_EQUALS(true, selector.has_next());
-        ASSERT_EQUALS(Move(SQ_F2, SQ_F4, Moves::DOUBLE_PAWN_PUSH_FLAG), selector.next());
-        ASSERT_EQUALS(true, selector.has_next());
-        ASSERT_EQUALS(Move(SQ_H2, SQ_H4, Moves::DOUBLE_PAWN_PUSH_FLAG), selector.next());
-        ASSERT_EQUALS(true, selector.has_next());
-        ASSERT_EQUALS(Move(SQ_A2, SQ_A3, Moves::QUIET_MOVE_FLAG), selector.next());
+        ASSERT_EQUALS(true, selector.has_next(strategy));
+        ASSERT_EQUALS(Move(SQ_C3, SQ_F6, Moves::CAPTURE_FLAG), selector.next(MoveOrdering::Selector::FULL_CASCADE, strategy));
+        ASSERT_EQUALS(true, selector.has_next(strategy));
+        ASSERT_EQUALS(Move(SQ_C3, SQ_C6, Moves::CAPTURE_FLAG), selector.next(MoveOrdering::Selector::FULL_CASCADE, strategy));
+        ASSERT_EQUALS(true, selector.has_next(strategy));
+        ASSERT_EQUALS(Move(SQ_G4, SQ_F6, Moves::CAPTURE_FLAG), selector.next(MoveOrdering::Selector::FULL_CASCADE, strategy));
+        ASSERT_EQUALS(true, selector.has_next(strategy));
+        ASSERT_EQUALS(Move(SQ_G4, SQ_H6, Moves::QUIET_MOVE_FLAG), selector.next(MoveOrdering::Selector::FULL_CASCADE, strategy));
+        ASSERT_EQUALS(true, selector.has_next(strategy));
+        ASSERT_EQUALS(Move(SQ_G4, SQ_E5, Moves::QUIET_MOVE_FLAG), selector.next(MoveOrdering::Selector::FULL_CASCADE, strategy));
+        ASSERT_EQUALS(true, selector.has_next(strategy));
+        ASSERT_EQUALS(Move(SQ_C3, SQ_C4, Moves::QUIET_MOVE_FLAG), selector.next(MoveOrdering::Selector::FULL_CASCADE, strategy));
+        ASSERT_EQUALS(true, selector.has_next(strategy));
+        ASSERT_EQUALS(Move(SQ_A2, SQ_A4, Moves::DOUBLE_PAWN_PUSH_FLAG), selector.next(MoveOrdering::Selector::FULL_CASCADE, strategy));
+        ASSERT_EQUALS(true, selector.has_next(strategy));
+        ASSERT_EQUALS(Move(SQ_F2, SQ_F4, Moves::DOUBLE_PAWN_PUSH_FLAG), selector.next(MoveOrdering::Selector::FULL_CASCADE, strategy));
+        ASSERT_EQUALS(true, selector.has_next(strategy));
+        ASSERT_EQUALS(Move(SQ_H2, SQ_H4, Moves::DOUBLE_PAWN_PUSH_FLAG), selector.next(MoveOrdering::Selector::FULL_CASCADE, strategy));
+        ASSERT_EQUALS(true, selector.has_next(strategy));
+        ASSERT_EQUALS(Move(SQ_A2, SQ_A3, Moves::QUIET_MOVE_FLAG), selector.next(MoveOrdering::Selector::FULL_CASCADE, strategy));
 
         return true;
     }
@@ -98,4 +103,197 @@ namespace Testing {
         return true;
     }
 
-}
\ No newline at end of file
+
+    // --------------------------------------
+    // Move ordering test - strict selection
+    // --------------------------------------
+
+    // Strict selection must not consume the next phase, so that quiet checks are still produced by a later cascade
+    REGISTER_TEST(move_ordering_strict_test)
+    {
+        Board board;
+        board.load_position("6r1/8/3p1b2/2p5/4N3/6q1/5b2/1k5K w - - 0 1");
+
+        MoveOrdering::Selector selector(&board, MoveGeneration::CAPTURE);
+
+        int captures = 0;
+        for (EMove move = selector.next(MoveOrdering::Selector::STRICT); move != Moves::null; move = selector.next(MoveOrdering::Selector::STRICT))
+            captures++;
+
+        ASSERT_EQUALS(5, captures);
+        ASSERT_EQUALS(MoveGeneration::CAPTURE, selector.phase());
+        ASSERT_EQUALS(Moves::null, selector.next(MoveOrdering::Selector::STRICT));
+
+        int quiet_checks = 0;
+        EMove move = selector.next(MoveOrdering::Selector::FULL_CASCADE);
+        while (move != Moves::null && selector.phase() == MoveGeneration::QUIET_CHECK) {
+            ASSERT_EQUALS(true, (move == Move(SQ_E4, SQ_D2, Moves::QUIET_MOVE_FLAG) || move == Move(SQ_E4, SQ_C3, Moves::QUIET_MOVE_FLAG)));
+            quiet_checks++;
+            move = selector.next(MoveOrdering::Selector::FULL_CASCADE);
+        }
+
+        ASSERT_EQUALS(2, quiet_checks);
+        ASSERT_EQUALS(Move(SQ_E4, SQ_G5, Moves::QUIET_MOVE_FLAG), move);
+        ASSERT_EQUALS(Moves::null, selector.next(MoveOrdering::Selector::FULL_CASCADE));
+
+        return true;
+    }
+
+
+    // --------------------------------------
+    // Move ordering test - staged selection
+    // --------------------------------------
+
+    // Focuses on testing the order of StagedSelector stages and whether every legal move is returned exactly once
+    REGISTER_TEST(move_ordering_staged_test)
+    {
+        Board board;
+        board.load_position("2r2r2/p1q1nk1p/bpp2pp1/8/4P1N1/1NQ5/PP3PPP/3RR1K1 w - - 2 22");
+
+        const Move tt_move(SQ_A2, SQ_A4, Moves::DOUBLE_PAWN_PUSH_FLAG);
+        const Move killers[] = { Move(SQ_A1, SQ_A8, Moves::QUIET_MOVE_FLAG), Move(SQ_H2, SQ_H3, Moves::QUIET_MOVE_FLAG) };
+        const Move counter_move(SQ_C3, SQ_D3, Moves::QUIET_MOVE_FLAG);
+
+        MoveOrdering::StagedSelector selector(&board, tt_move, killers, counter_move);
+        auto indexer = [](const Move& move) -> int32_t { return move.is_double_pawn_push(); };
+
+        // Transposition table move is returned first, and illegal killer is skipped
+        ASSERT_EQUALS(tt_move, selector.next(indexer));
+        ASSERT_EQUALS(MoveOrdering::StagedSelector::TT_MOVE, selector.stage());
+
+        Moves::List<Move> legal_moves;
+        MoveGeneration::generate_legal_moves<MoveGeneration::PSEUDO_LEGAL>(board, legal_moves);
+
+        uint32_t count = 1, counter_moves = 0;
+        MoveOrdering::StagedSelector::Stage last_stage = MoveOrdering::StagedSelector::TT_MOVE;
+
+        for (EMove move = selector.next(indexer); move != Moves::null; move = selector.next(indexer), count++) {
+            const auto stage = selector.stage();
+
+            ASSERT_EQUALS(true, (stage >= last_stage));
+            ASSERT_EQUALS(true, (move != tt_move));
+            ASSERT_EQUALS(true, (std::find(legal_moves.begin(), legal_moves.end(), move) != legal_moves.end()));
+
+            if (stage == MoveOrdering::StagedSelector::GOOD_CAPTURES)
+                ASSERT_EQUALS(true, board.see_ge(move, 1));
+            if (stage == MoveOrdering::StagedSelector::KILLERS)
+                ASSERT_EQUALS(killers[1], move);
+            if (stage == MoveOrdering::StagedSelector::COUNTER_MOVE) {
+                ASSERT_EQUALS(counter_move, move);
+                counter_moves++;
+            }
+            if (stage == MoveOrdering::StagedSelector::QUIETS)
+                ASSERT_EQUALS(true, (move.is_quiet() && move != killers[1] && move != counter_move));
+            if (stage == MoveOrdering::StagedSelector::BAD_CAPTURES)
+                ASSERT_EQUALS(false, board.see_ge(move, 1));
+
+            last_stage = stage;
+        }
+
+        ASSERT_EQUALS(legal_moves.size(), count);
+        ASSERT_EQUALS(1, counter_moves);
+        ASSERT_EQUALS(MoveOrdering::StagedSelector::BAD_CAPTURES, selector.stage());
+
+        return true;
+    }
+
+
+    // ----------------------------------
+    // Move ordering test - history merge
+    // ----------------------------------
+
+    // Per-thread history tables are merged by averaging scores of all the tables with equal weights, while the counter moves are filled in
+    REGISTER_TEST(history_merge_test)
+    {
+        std::unique_ptr<Search::History> main = std::make_unique<Search::History>();
+        std::unique_ptr<Search::History> local[3];
+        for (std::unique_ptr<Search::History>& history : local)
+            history = std::make_unique<Search::History>();
+
+        local[0]->update(W_KNIGHT, SQ_F3, 100, 1, 1, 0, HISTORY_MAX_SCORE);
+        local[1]->update(W_KNIGHT, SQ_F3, 100, 1, 1, 0, -HISTORY_MAX_SCORE / 2);
+        local[2]->update(W_KNIGHT, SQ_F3, 100, 1, 1, 0, HISTORY_MAX_SCORE / 2);
+        local[2]->update(B_QUEEN, SQ_D1, ROOK, 100, 1, 1, 0, 3 * (HISTORY_MAX_SCORE / 4));
+        local[1]->update(local[1]->continuation(W_PAWN, SQ_E4), B_PAWN, SQ_E5, 100, 1, 1, 0, HISTORY_MAX_SCORE);
+        local[1]->update_counter_move(local[1]->continuation(W_PAWN, SQ_E4), Move(SQ_E7, SQ_E5, Moves::DOUBLE_PAWN_PUSH_FLAG));
+
+        // Main table keeps its own data only if it takes part in the merge
+        main->update(W_KNIGHT, SQ_F3, 100, 1, 1, 0, -HISTORY_MAX_SCORE);
+
+        const Search::History* tables[] = { local[0].get(), local[1].get(), local[2].get() };
+        main->merge(tables);
+
+        ASSERT_EQUALS(HISTORY_MAX_SCORE / 3, main->score(W_KNIGHT, SQ_F3));
+        ASSERT_EQUALS(HISTORY_MAX_SCORE / 4, main->score(B_QUEEN, SQ_D1, ROOK));
+        ASSERT_EQUALS(HISTORY_MAX_SCORE / 3, main->score(main->continuation(W_PAWN, SQ_E4), B_PAWN, SQ_E5));
+        ASSERT_EQUALS(Move(SQ_E7, SQ_E5, Moves::DOUBLE_PAWN_PUSH_FLAG), main->counter_move(main->continuation(W_PAWN, SQ_E4)));
+
+        // Including the main table gives it the same weight as any other table
+        const Search::History* all_tables[] = { main.get(), local[0].get() };
+        main->merge(all_tables);
+
+        ASSERT_EQUALS((HISTORY_MAX_SCORE / 3 + HISTORY_MAX_SCORE) / 2, main->score(W_KNIGHT, SQ_F3));
+        ASSERT_EQUALS(Move(SQ_E7, SQ_E5, Moves::DOUBLE_PAWN_PUSH_FLAG), main->counter_move(main->continuation(W_PAWN, SQ_E4)));
+
+        return true;
+    }
+
+    // -------------------------------
+    // Move ordering test - speed test
+    // -------------------------------
+
+    // Measures the time needed to fully iterate both selectors with indexers resembling the ones used in search
+    void move_ordering_speed_test(uint32_t repetitions)
+    {
+        const std::string positions[] = {
+            Chessboard::STARTING_POSITION,
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "2r2r2/p1q1nk1p/bpp2pp1/8/4P1N1/1NQ5/PP3PPP/3RR1K1 w - - 2 22",
+        };
+        const Move killers[] = { Moves::null, Moves::null };
+
+        for (const std::string& fen : positions) {
+            Board board;
+            board.load_position(fen);
+
+            auto indexer = [&board](const Move& move) -> int32_t {
+                if (!move.is_quiet()) {
+                    int32_t see = board.see(move);
+                    if (see > 0)
+                        return (1 << 16) + see;
+                }
+                return (move.from() * 31 + move.to() * 17) % 200;
+            };
+
+            // Checksum prevents compiler from optimizing the loops away
+            uint64_t checksum = 0;
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < repetitions; i++) {
+                MoveOrdering::StagedSelector selector(&board, Moves::null, killers);
+                for (EMove move = selector.next(indexer); move != Moves::null; move = selector.next(indexer))
+                    checksum += move.raw();
+            }
+            auto middle = std::chrono::steady_clock::now();
+
+            for (uint32_t i = 0; i < repetitions; i++) {
+                MoveOrdering::Selector selector(&board, MoveGeneration::CAPTURE);
+                MoveOrdering::sort(selector, [&board](const Move& move) -> int32_t {
+                    return board.see(move);
+                }, Moves::Enhancement::PURE_SEE);
+
+                for (EMove move = selector.next(MoveOrdering::Selector::STRICT); move != Moves::null; move = selector.next(MoveOrdering::Selector::STRICT))
+                    checksum += move.raw();
+            }
+            auto end = std::chrono::steady_clock::now();
+
+            std::chrono::duration<double> staged_time = middle - start;
+            std::chrono::duration<double> capture_time = end - middle;
+
+            std::cout << "----- Move ordering: " << fen << " (checksum " << checksum << ") -----\n";
+            std::cout << "> Staged selector: " << uint64_t(staged_time.count() * 1e9 / repetitions) << " ns/node\n";
+            std::cout << "> Capture selector: " << uint64_t(capture_time.count() * 1e9 / repetitions) << " ns/node\n";
+        }
+    }
+
+}
@@ -1,9 +1,11 @@
 #include "test.h"
 #include "../src/engine/engine.h"
+#include "../src/engine/randomgen.h"
 #include "../src/utilities/parsing.h"
 #include <chrono>
 #include <fstream>
 #include <memory>
+#include <thread>
 #include <vector>
 
 // Since we cannot really perform unit tests on search heuristics, these tests have different format
@@ -14,9 +16,9 @@ namespace Testing {
 
     // This test focuses on measuring engine's speed
     // - We do not check the return value in any way
-    void search_speed_test(Search::Depth depth)
+    void search_speed_test(Search::Depth depth, std::string network)
     {
-        std::unique_ptr<Engine> engine = std::make_unique<Engine>(Engine::Mode::STATS);
+        std::unique_ptr<Engine> engine = std::make_unique<Engine>(Engine::Mode::STATS, network);
 
         // A few different positions
         std::vector<std::string> positions = {
@@ -28,7 +30,7 @@ namespace Testing {
             "8/4kbp1/5p2/5Q1p/8/8/5K2/8 w - - 1 51",                                    // Endgame position, complex
         };
 
-        for (int i = 0; i < positions.size(); i++) {
+        for (std::size_t i = 0; i < positions.size(); i++) {
             engine->set_position(positions[i]);
 
             std::cout << "----- Position " << i + 1 << " -----\n";
@@ -39,9 +41,9 @@ namespace Testing {
 
     // This test measures both search speed and accuracy
     // - Accuracy is measured by comparing engine's first choice suggestions to best moves pointed out in data file
-    void search_accuracy_test(Search::Depth depth, std::string input)
+    void search_accuracy_test(Search::Depth depth, std::string input, std::string network)
     {
-        std::unique_ptr<Engine> engine = std::make_unique<Engine>(Engine::Mode::STANDARD);
+        std::unique_ptr<Engine> engine = std::make_unique<Engine>(Engine::Mode::STANDARD, network);
 
         // Load input file
         std::ifstream input_file(input);
@@ -108,4 +110,95 @@ namespace Testing {
         std::cout << "Total search time: " << search_time.count() << " seconds \n";
     }
 
+
+    // This test compares history heuristic throughput of a single shared table and per-thread tables
+    // - Every thread simulates a sequence of nodes, which read scores of a few dozen moves and update some of them
+    // - Per-thread tables are merged into the main table at the end, and the merge time is included in the measurement
+    void history_scaling_speed_test(unsigned threads, uint32_t nodes)
+    {
+        constexpr int READS_PER_NODE = 32;
+        constexpr int UPDATES_PER_NODE = 4;
+
+        // Random accesses are generated upfront, so that the generator does not dominate the measurement
+        struct Access { Piece piece; Square to; Piece previous_piece; Square previous_to; };
+
+        Random::StandardGenerator<uint64_t> generator(2137);
+        std::vector<std::vector<Access>> accesses(threads);
+
+        for (std::vector<Access>& thread_accesses : accesses) {
+            thread_accesses.resize(nodes);
+
+            for (Access& access : thread_accesses) {
+                uint64_t random = generator.random();
+                access = { Piece(random % PIECE_RANGE), Square((random >> 8) % SQUARE_RANGE), 
+                           Piece((random >> 16) % PIECE_RANGE), Square((random >> 24) % SQUARE_RANGE) };
+            }
+        }
+
+        // A single node - ordering reads followed by history updates
+        auto visit = [](Search::History& history, const Access& access) -> int32_t {
+            Search::History::Continuation* continuation = history.continuation(access.previous_piece, access.previous_to);
+            int32_t sum = 0;
+
+            for (int i = 0; i < READS_PER_NODE; i++) {
+                Square to = Square((access.to + i) % SQUARE_RANGE);
+                sum += history.score(access.piece, to) + history.score(continuation, access.piece, to);
+            }
+
+            for (int i = 0; i < UPDATES_PER_NODE; i++) {
+                Square to = Square((access.to + i) % SQUARE_RANGE);
+                history.update(access.piece, to, HISTORY_CUT_FACTOR, 10, 10, 1, HISTORY_MAX_SCORE);
+                history.update(continuation, access.piece, to, HISTORY_CUT_FACTOR, 10, 10, 1, HISTORY_MAX_SCORE);
+            }
+
+            return sum;
+        };
+
+        // Measures throughput of given number of threads, each working on the table returned by table(thread)
+        auto measure = [&](const std::string& name, unsigned no_threads, auto&& table, auto&& finish) {
+            std::vector<std::thread> workers;
+            std::vector<int32_t> sums(no_threads);
+
+            auto start = std::chrono::steady_clock::now();
+            for (unsigned t = 0; t < no_threads; t++) {
+                workers.emplace_back([&, t]() {
+                    Search::History& history = table(t);
+                    for (const Access& access : accesses[t])
+                        sums[t] += visit(history, access);
+                });
+            }
+
+            for (std::thread& worker : workers)
+                worker.join();
+            finish(no_threads);
+            auto end = std::chrono::steady_clock::now();
+
+            std::chrono::duration<double> time = end - start;
+
+            std::cout << std::dec << "> " << name << ", " << no_threads << " threads: " << (long long)(no_threads * nodes / time.count()) << " nodes/s\n";
+        };
+
+        // History tables are large, so they are allocated on the heap
+        std::unique_ptr<Search::History> shared = std::make_unique<Search::History>();
+        std::vector<std::unique_ptr<Search::History>> local(threads);
+        for (std::unique_ptr<Search::History>& history : local)
+            history = std::make_unique<Search::History>();
+
+        std::cout << "----- History throughput (" << nodes << " nodes per thread) -----\n";
+        for (unsigned no_threads : { 1u, threads }) {
+            shared->reset();
+            measure("Shared table", no_threads, [&](unsigned) -> Search::History& { return *shared; }, [](unsigned) {});
+
+            shared->reset();
+            for (std::unique_ptr<Search::History>& history : local)
+                history->reset();
+            measure("Per-thread tables", no_threads, [&](unsigned t) -> Search::History& { return *local[t]; }, [&](unsigned n) {
+                std::vector<const Search::History*> tables;
+                for (unsigned t = 0; t < n; t++)
+                    tables.push_back(local[t].get());
+                shared->merge(tables);
+            });
+        }
+    }
+
 }
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include "test.h"
 #include "../src/engine/board.h"
 #include "../src/engine/evalconfig.h"
+#include "../src/engine/movegen.h"
+#include "../src/engine/randomgen.h"
+#include <chrono>
+#include <vector>
 
 
 namespace Testing {
@@ -31,4 +35,170 @@ namespace Testing {
         return true;
     }
 
+
+    // ------------------------------------------------
+    // Static Exchange Evaluation test - threshold test
+    // ------------------------------------------------
+
+    // SEE threshold test must agree with the sign of full SEE for every move
+    // - see() stops the exchange once its sign is settled, so only thresholds 0 and 1 are comparable in general
+    // - see() ignores pins and lets the king recapture on defended squares, so such exchanges are checked separately
+    // - Exact values of the reference positions above are checked as bounds
+    REGISTER_TEST(see_threshold_test)
+    {
+        const std::string positions[] = {
+            "1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1",
+            "1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1",
+            "4r1k1/pp3ppp/2pb1B2/3p1b2/3P4/1BN4P/PPP2PP1/4R1K1 b - - 0 17",
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "2r2r2/p1q1nk1p/bpp2pp1/8/4P1N1/1NQ5/PP3PPP/3RR1K1 w - - 2 22",
+            "r1bq2k1/ppppbrpp/8/4Pp1Q/4pB2/2N5/PPP2PPP/R3R1K1 w - - 2 15",
+            "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+        };
+
+        Board board;
+
+        for (const std::string& fen : positions) {
+            board.load_position(fen);
+
+            Moves::List<Move> moves;
+            MoveGeneration::generate_legal_moves<MoveGeneration::PSEUDO_LEGAL>(board, moves);
+
+            Bitboard special = board.pieces(KING) | board.pinned(WHITE) | board.pinned(BLACK);
+
+            for (const Move& move : moves) {
+                if (board.attackers_to(move.to()) & special)
+                    continue;
+
+                int32_t see = board.see(move);
+                ASSERT_EQUALS((see >= 0), board.see_ge(move, 0));
+                ASSERT_EQUALS((see >= 1), board.see_ge(move, 1));
+            }
+        }
+
+        // Position 1
+        board.load_position(positions[0]);
+        Move move1(SQ_E1, SQ_E5, Moves::CAPTURE_FLAG);
+        ASSERT_EQUALS(true, board.see_ge(move1, Evaluation::PieceValues[PAWN]));
+        ASSERT_EQUALS(false, board.see_ge(move1, Evaluation::PieceValues[PAWN] + 1));
+
+        // Position 2
+        board.load_position(positions[1]);
+        Move move2(SQ_D3, SQ_E5, Moves::CAPTURE_FLAG);
+        ASSERT_EQUALS(true, board.see_ge(move2, Evaluation::PieceValues[PAWN] - Evaluation::PieceValues[KNIGHT]));
+        ASSERT_EQUALS(false, board.see_ge(move2, Evaluation::PieceValues[PAWN] - Evaluation::PieceValues[KNIGHT] + 1));
+
+        // Position 3
+        board.load_position(positions[2]);
+        Move move3(SQ_E8, SQ_E1, Moves::CAPTURE_FLAG);
+        ASSERT_EQUALS(true, board.see_ge(move3, Evaluation::PieceValues[ROOK]));
+        ASSERT_EQUALS(false, board.see_ge(move3, Evaluation::PieceValues[ROOK] + 1));
+
+        // King cannot recapture on a square defended by the queen
+        board.load_position(positions[4]);
+        Move move4(SQ_G4, SQ_F6, Moves::CAPTURE_FLAG);
+        ASSERT_EQUALS(true, board.see_ge(move4, Evaluation::PieceValues[PAWN]));
+        ASSERT_EQUALS(false, board.see_ge(move4, Evaluation::PieceValues[PAWN] + 1));
+
+        // Pinned knight cannot recapture
+        board.load_position("7k/8/5n2/3p4/3B4/2N5/8/6K1 w - - 0 1");
+        Move move5(SQ_C3, SQ_D5, Moves::CAPTURE_FLAG);
+        ASSERT_EQUALS(true, board.see_ge(move5, Evaluation::PieceValues[PAWN]));
+        ASSERT_EQUALS(false, board.see_ge(move5, Evaluation::PieceValues[PAWN] + 1));
+
+        // Knight is no longer pinned once the pinning bishop is gone
+        board.load_position("7k/8/5n2/3p4/8/2N5/8/6K1 w - - 0 1");
+        ASSERT_EQUALS(false, board.see_ge(move5, 0));
+
+        // Promoted queen is lost to the rook, so the promotion loses the pawn
+        board.load_position("r3k3/1P6/8/8/8/8/8/4K3 w - - 0 1");
+        Move move6(SQ_B7, SQ_B8, Moves::QUEEN_PROMOTION_FLAG);
+        ASSERT_EQUALS(-Evaluation::PieceValues[PAWN], board.see(move6));
+        ASSERT_EQUALS(true, board.see_ge(move6, -Evaluation::PieceValues[PAWN]));
+        ASSERT_EQUALS(false, board.see_ge(move6, -Evaluation::PieceValues[PAWN] + 1));
+
+        // Enpassant wins a pawn, unless the capturing pawn can be recaptured
+        board.load_position("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1");
+        Move move7(SQ_E5, SQ_D6, Moves::ENPASSANT_FLAG);
+        ASSERT_EQUALS(Evaluation::PieceValues[PAWN], board.see(move7));
+        ASSERT_EQUALS(true, board.see_ge(move7, Evaluation::PieceValues[PAWN]));
+        ASSERT_EQUALS(false, board.see_ge(move7, Evaluation::PieceValues[PAWN] + 1));
+
+        board.load_position("4k3/2p5/8/3pP3/8/8/8/4K3 w - d6 0 1");
+        ASSERT_EQUALS(0, board.see(move7));
+        ASSERT_EQUALS(true, board.see_ge(move7, 0));
+        ASSERT_EQUALS(false, board.see_ge(move7, 1));
+
+        return true;
+    }
+
+
+
+    // -------------------------------------------------
+    // Static Exchange Evaluation test - speed test
+    // -------------------------------------------------
+
+    // Compares full SEE with the threshold test on the reference positions and on a sample of random positions
+    // - Every legal move of each position is evaluated
+    void see_speed_test(unsigned no_positions)
+    {
+        // Reference positions first, then random playouts from the starting position
+        std::vector<Board> boards;
+        for (const char* fen : { "1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1",
+                                 "1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1",
+                                 "4r1k1/pp3ppp/2pb1B2/3p1b2/3P4/1BN4P/PPP2PP1/4R1K1 b - - 0 17" }) {
+            boards.emplace_back();
+            boards.back().load_position(fen);
+        }
+
+        Random::StandardGenerator<uint64_t> generator(2137);
+        while (boards.size() < no_positions) {
+            Board board;
+            unsigned length = unsigned(generator.random() % 80);
+
+            for (unsigned ply = 0; ply < length; ply++) {
+                Moves::List<Move> movelist;
+                MoveGeneration::generate_moves<MoveGeneration::LEGAL>(board, movelist);
+
+                if (movelist.empty())
+                    break;
+
+                board.make_move(movelist[int(generator.random() % movelist.size())]);
+            }
+
+            boards.push_back(board);
+        }
+
+        std::vector<std::pair<const Board*, Move>> moves;
+        for (const Board& board : boards) {
+            Moves::List<Move> movelist;
+            MoveGeneration::generate_moves<MoveGeneration::LEGAL>(board, movelist);
+
+            for (const Move& move : movelist)
+                moves.emplace_back(&board, move);
+        }
+
+        // Measures throughput of given SEE method
+        auto measure = [&moves](const std::string& name, auto&& method) {
+            uint32_t positive = 0;
+
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < 16; i++)
+                for (const auto& [board, move] : moves)
+                    positive += method(*board, move);
+            auto end = std::chrono::steady_clock::now();
+
+            std::chrono::duration<double> time = end - start;
+
+            std::cout << std::dec << "> " << name << ": " << (long long)(16 * moves.size() / time.count()) << " moves/s (" 
+                      << positive / 16 << " passed)\n";
+        };
+
+        std::cout << "----- SEE throughput (" << boards.size() << " positions, " << moves.size() << " moves) -----\n";
+        measure("see() > 0", [](const Board& board, const Move& move) { return board.see(move) > 0; });
+        measure("see_ge(1)", [](const Board& board, const Move& move) { return board.see_ge(move, 1); });
+        measure("see() >= -100", [](const Board& board, const Move& move) { return board.see(move) >= -100; });
+        measure("see_ge(-100)", [](const Board& board, const Move& move) { return board.see_ge(move, -100); });
+    }
+
 }
\ No newline at end of file
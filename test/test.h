@@ -93,7 +93,15 @@ namespace Testing {
 	// Special tests - declarations
 	// ----------------------------
 
-    void search_speed_test(int8_t depth);
-    void search_accuracy_test(int8_t depth, std::string input = "test/data/search_test_data_custom.txt");
+    void search_speed_test(int8_t depth, std::string network = "model/model_best.nnue");
+    void search_accuracy_test(int8_t depth, std::string input = "test/data/search_test_data_custom.txt",
+                              std::string network = "model/model_best.nnue");
+    void nnue_batch_speed_test(unsigned no_positions, unsigned threads);
+    void nnue_quantization_test(int8_t depth, std::string input = "test/data/search_test_data_custom.txt");
+    void movegen_perft_speed_test(uint32_t depth);
+    void board_packing_speed_test(uint32_t repetitions);
+    void move_ordering_speed_test(uint32_t repetitions);
+    void history_scaling_speed_test(unsigned threads = 8, uint32_t nodes = 1 << 20);
+    void see_speed_test(unsigned no_positions);
 
 }
\ No newline at end of file